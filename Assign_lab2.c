@@ -1,6 +1,57 @@
+#ifndef _WIN32
+#define _FILE_OFFSET_BITS 64    // 64-bit off_t on 32-bit systems too
+#define _POSIX_C_SOURCE 200809L // fseeko/ftello
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#include "ttt_thread.h"
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define PASS_CGPA       2.7f
+#define CHUNK_RECORDS   65536      // Students held in memory at a time in bulk mode
+#define CHUNK_BYTES     (1 << 22)  // Raw text read into each chunk
+#define CHUNK_LINE      128
+#define MAX_WORKERS     8          // Chunks classified at once in bulk mode
+#define IO_BUFFER       (1 << 20)
+#define FILE_CHUNK      (1 << 16)  // Bytes read from each end of a file per step
+
+// File offsets past 2 GB: long is 32 bits on Windows
+#ifdef _WIN32
+#define fseek64(fp, offset, whence) _fseeki64(fp, offset, whence)
+#define ftell64(fp)                 _ftelli64(fp)
+#else
+#define fseek64(fp, offset, whence) fseeko(fp, (off_t)(offset), whence)
+#define ftell64(fp)                 ((long long)ftello(fp))
+#endif
+
+// One chunk of students: the raw lines, their columns and the report text.
+// The file is streamed through a fixed set of chunks, one per worker, so
+// memory stays the same however many records there are
+struct StudentChunk
+{
+    char *text;                 // Lines as read, each ending in '\0'
+    int lines;
+    char name[CHUNK_RECORDS][20];
+    int ID[CHUNK_RECORDS];
+    float cgpa[CHUNK_RECORDS];
+    unsigned char pass[CHUNK_RECORDS];
+    int count;
+    long long passed;
+    long long skipped;          // Lines that are not name,ID,CGPA
+    char *report;
+    size_t reportLen;
+    size_t reportCap;
+};
 
 void displaymenu();
 void prob1();
@@ -8,10 +59,22 @@ void rev(int arr[], int n);
 void prob2();
 void prob3();
 void prob4();
+void classifyChunk(const float *cgpa, unsigned char *pass, int n, float threshold);
+int readChunk(FILE *in, struct StudentChunk *chunk);
+int readLine(FILE *in, char *line);
+void *processChunk(void *arg);
+void appendReport(struct StudentChunk *chunk, int i);
+void classifyFile(const char *inName, const char *outName);
 void prob5();
 void prinarray(int* ptr, int n);
 void prob6();
 void AreaCircle(int *r);
+void prob7();
+void reverseInPlace(int *arr, size_t n);
+size_t mirrorMismatch(const char *front, const char *back, size_t n);
+int isPalindrome(const char *s, size_t len);
+int isPalindromeFile(const char *name);
+void printArray(const int *arr, size_t n, FILE *out);
 
 int main()
 {
@@ -62,6 +125,10 @@ int main()
             prob6();
             break;
 
+            case 7:
+            prob7();
+            break;
+
             default:
             printf("Invalid choice. Please try again.\n");
             break;
@@ -81,6 +148,7 @@ void displaymenu()
     printf("4. Make a user-defined datatype Student that will store the student's name, ID, CGPA, and status. If the CGPA is \nbelow 2.7, then the status will automatically update to Fail; otherwise, it will be updated to Pass.\n");
     printf("5. Write a function that will print an integer array of size 5 using a pointer.\n");
     printf("6. Implement the following function and show the area of a Circle.\n void AreaCircle(int *r);\n");
+    printf("7. Benchmark the large-input reverse, palindrome and printing kernels against the simple loops.\n");
 }
 void prob1()
 {
@@ -94,9 +162,28 @@ void rev(int arr[], int n)
 {
     printf("Reverse:\n");
 
-    for (int i = n - 1; i>=0; i--)
+    reverseInPlace(arr, n);
+    printArray(arr, n, stdout);
+}
+
+// Swaps four ints from each end per step, reversing each group in register
+void reverseInPlace(int *arr, size_t n)
+{
+    size_t i = 0, j = n;
+#ifdef __SSE2__
+    for (; i + 8 <= j; i += 4, j -= 4)
     {
-        printf("%d\n",arr[i]);
+        __m128i front = _mm_loadu_si128((const __m128i *)(arr + i));
+        __m128i back = _mm_loadu_si128((const __m128i *)(arr + j - 4));
+        _mm_storeu_si128((__m128i *)(arr + i), _mm_shuffle_epi32(back, _MM_SHUFFLE(0, 1, 2, 3)));
+        _mm_storeu_si128((__m128i *)(arr + j - 4), _mm_shuffle_epi32(front, _MM_SHUFFLE(0, 1, 2, 3)));
+    }
+#endif
+    for (; i + 1 < j; i++, j--)
+    {
+        int t = arr[i];
+        arr[i] = arr[j - 1];
+        arr[j - 1] = t;
     }
 }
 
@@ -124,60 +211,194 @@ void prob2()
 
 void prob3()
 {
+    int mode, c;
+    printf("1. Check a word\n2. Check a file\n");
+    printf("Choice: ");
+    scanf("%d",&mode);
+    while ((c = getchar()) != '\n' && c != EOF)
+    {
+        // Drop the rest of the line so fgets gets the word
+    }
+
+    if (mode == 2)
+    {
+        char name[256];
+        printf("File: ");
+        scanf("%255s", name);
+        fflush(stdin);
+
+        int result = isPalindromeFile(name);
+        if (result < 0)
+        {
+            printf("Cannot open %s.\n", name);
+        }
+        else
+        {
+            printf(result ? "Palindrome.\n" : "Not palindrome.\n");
+        }
+        return;
+    }
 
     char s[80];
     printf("Enter a word: ");
     fgets(s,80,stdin);
 
-    int flag, len = strlen(s);
-    if (len > 0 && s[len] == '\n')
+    int len = strlen(s);
+    if (len > 0 && s[len - 1] == '\n')
     {
-        s[len] = '\0';
+        s[--len] = '\0';
     }
 
-    for (int i = 0; s[i] != '\0';i++)
+    if (isPalindrome(s, len))
     {
-        flag = 0;
-       for (int j = len - 1; s[j] != '\0';j--)
-        {
-            if ( s[i] != s[j-1])
-            {
-                flag = 1;
-                break;
-            }
-        }
-        if (flag == 1)
+        printf("Palindrome.\n");
+    }
+    else
+    {
+        printf("Not palindrome.\n");
+    }
+}
+
+#ifdef __SSE2__
+// Reverses the 16 bytes of a vector (SSE2 has no byte shuffle)
+__m128i reverseBytes(__m128i v)
+{
+    v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+}
+#endif
+
+// Compares front[k] with back[n - 1 - k] for every k < n, 16 bytes a step.
+// Returns n if they all match, otherwise the first k that differs.
+size_t mirrorMismatch(const char *front, const char *back, size_t n)
+{
+    size_t k = 0;
+#ifdef __SSE2__
+    for (; k + 16 <= n; k += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(front + k));
+        __m128i b = reverseBytes(_mm_loadu_si128((const __m128i *)(back + n - 16 - k)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF)
         {
             break;
         }
-        else
+    }
+#endif
+    for (; k < n; k++)
+    {
+        if (front[k] != back[n - 1 - k])
         {
-            continue;
+            return k;
         }
+    }
+    return n;
+}
 
+// Two pointers from both ends: the first half against the reversed second half
+int isPalindrome(const char *s, size_t len)
+{
+    size_t half = len / 2;
+    return mirrorMismatch(s, s + len - half, half) == half;
+}
+
+// Reads matching blocks from the start and the end of the file and moves
+// both inward, so only two blocks are in memory at a time. A trailing line
+// break is not part of the text. Returns -1 if the file cannot be read.
+int isPalindromeFile(const char *name)
+{
+    FILE *fp = fopen(name, "rb");
+    static char front[FILE_CHUNK], back[FILE_CHUNK];
+    long long lo = 0, hi;
+
+    if (fp == NULL || fseek64(fp, 0, SEEK_END) != 0 || (hi = ftell64(fp)) < 0)
+    {
+        if (fp != NULL) fclose(fp);
+        return -1;
     }
-    if (flag == 0)
+
+    while (hi > 0)
     {
-        printf("Not palindrome.\n");
+        fseek64(fp, hi - 1, SEEK_SET);
+        int c = fgetc(fp);
+        if (c != '\n' && c != '\r')
+        {
+            break;
+        }
+        hi--;
     }
-    else
+
+    int result = 1;
+    while (hi - lo >= 2)
     {
-        printf("Palindrome.\n");
+        size_t n = (hi - lo) / 2;
+        if (n > FILE_CHUNK)
+        {
+            n = FILE_CHUNK;
+        }
+
+        fseek64(fp, lo, SEEK_SET);
+        size_t got = fread(front, 1, n, fp);
+        fseek64(fp, hi - (long long)n, SEEK_SET);
+        got += fread(back, 1, n, fp);
+        if (got != 2 * n)
+        {
+            result = -1;
+            break;
+        }
+
+        if (mirrorMismatch(front, back, n) != n)
+        {
+            result = 0;
+            break;
+        }
+        lo += n;
+        hi -= n;
     }
+
+    fclose(fp);
+    return result;
 }
 
 void prob4()
 {
-    int i,n;
+    int i,n,mode;
+    printf("1. Enter students\n2. Classify a student file (name,ID,CGPA per line)\n");
+    printf("Choice: ");
+    scanf("%d",&mode);
+    fflush(stdin);
+    if (mode == 2)
+    {
+        char in[256], out[256];
+        printf("Input file: ");
+        scanf("%255s", in);
+        printf("Report file: ");
+        scanf("%255s", out);
+        fflush(stdin);
+        classifyFile(in, out);
+        return;
+    }
+
     printf("How many students? ");
     scanf("%d",&n);
     fflush(stdin);
+    if (n < 1)
+    {
+        printf("Invalid number of students.\n");
+        return;
+    }
     struct Student
     {
         char name[20];
         int ID;
         float cgpa;
-    } std[n];
+    } *std = malloc(n * sizeof(struct Student));
+    if (std == NULL)
+    {
+        printf("Not enough memory.\n");
+        return;
+    }
     for (i = 0; i < n; i++)
     {
     printf("Name: ");
@@ -192,13 +413,13 @@ void prob4()
     scanf("%f", &std[i].cgpa);
     fflush(stdin);
     }
-    printf("Name\t\tID\t/tCGPA\t/tStatus\n");
+    printf("Name\t\tID\tCGPA\tStatus\n");
     for (i = 0; i < n; i++)
     {
         printf("%s\t%d\t%f",std[i].name,std[i].ID,std[i].cgpa);
         
 
-        if (std[i].cgpa < 2.7)
+        if (std[i].cgpa < PASS_CGPA)
         {
             printf("\tFail\n");
         }
@@ -207,7 +428,255 @@ void prob4()
             printf("\tPass\n");
         }
     }
+    free(std);
+
+}
+
+// pass[i] = 1 when cgpa[i] >= threshold, four records per SSE compare
+void classifyChunk(const float *cgpa, unsigned char *pass, int n, float threshold)
+{
+    int i = 0;
+#ifdef __SSE__
+    __m128 limit = _mm_set1_ps(threshold);
+    for (; i + 4 <= n; i += 4)
+    {
+        int mask = _mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(cgpa + i), limit));
+        pass[i] = mask & 1;
+        pass[i + 1] = (mask >> 1) & 1;
+        pass[i + 2] = (mask >> 2) & 1;
+        pass[i + 3] = (mask >> 3) & 1;
+    }
+#endif
+    for (; i < n; i++)
+    {
+        pass[i] = (cgpa[i] >= threshold);
+    }
+}
+
+// Reads up to CHUNK_RECORDS raw lines (or CHUNK_BYTES of text) into the
+// chunk; the parsing is left to the workers. Returns the number of lines.
+int readChunk(FILE *in, struct StudentChunk *chunk)
+{
+    size_t len = 0;
+    chunk->lines = 0;
 
+    while (chunk->lines < CHUNK_RECORDS && CHUNK_BYTES - len >= CHUNK_LINE &&
+           readLine(in, chunk->text + len))
+    {
+        len += strlen(chunk->text + len) + 1;
+        chunk->lines++;
+    }
+    return chunk->lines;
+}
+
+// Reads one line into CHUNK_LINE bytes. A longer line is still one line:
+// a name too long to fit is cut to the 19 characters a record keeps, so
+// the ID and CGPA after it are read, and anything else that does not fit
+// is dropped up to the end of the line. Returns 0 at the end of the file.
+int readLine(FILE *in, char *line)
+{
+    if (fgets(line, CHUNK_LINE, in) == NULL)
+    {
+        return 0;
+    }
+
+    size_t len = strlen(line);
+    if (len < CHUNK_LINE - 1 || line[len - 1] == '\n')
+    {
+        return 1;
+    }
+
+    int inName = (strchr(line, ',') == NULL);
+    int c;
+    if (inName)
+    {
+        len = 19;
+    }
+    while ((c = getc(in)) != EOF && c != '\n')
+    {
+        if (inName && c != ',')
+        {
+            continue;
+        }
+        inName = 0;
+        if (len < CHUNK_LINE - 1)
+        {
+            line[len++] = (char)c;
+        }
+    }
+    line[len] = '\0';
+    return 1;
+}
+
+// Worker: parses the chunk's lines into the columns, classifies them and
+// formats the report, all in the chunk's own buffers
+void *processChunk(void *arg)
+{
+    struct StudentChunk *chunk = arg;
+    char *line = chunk->text;
+
+    chunk->count = 0;
+    chunk->passed = 0;
+    chunk->skipped = 0;
+    chunk->reportLen = 0;
+
+    for (int l = 0; l < chunk->lines; l++)
+    {
+        int k = chunk->count;
+        const char *fields = strchr(line, ',');
+
+        // Names longer than 19 characters are cut, not counted as bad lines
+        if (fields != NULL && sscanf(line, " %19[^,]", chunk->name[k]) == 1 &&
+            sscanf(fields, ",%d,%f", &chunk->ID[k], &chunk->cgpa[k]) == 2)
+        {
+            chunk->count++;
+        }
+        else if (line[0] != '\n' && line[0] != '\r')
+        {
+            chunk->skipped++;
+        }
+        line += strlen(line) + 1;
+    }
+
+    classifyChunk(chunk->cgpa, chunk->pass, chunk->count, PASS_CGPA);
+    for (int i = 0; i < chunk->count; i++)
+    {
+        appendReport(chunk, i);
+        chunk->passed += chunk->pass[i];
+    }
+    return NULL;
+}
+
+// Formats one report line; the buffer doubles on the rare line that does not fit
+void appendReport(struct StudentChunk *chunk, int i)
+{
+    for (;;)
+    {
+        size_t room = chunk->reportCap - chunk->reportLen;
+        int n = snprintf(chunk->report + chunk->reportLen, room, "%s\t%d\t%.2f\t%s\n",
+                         chunk->name[i], chunk->ID[i], chunk->cgpa[i], chunk->pass[i] ? "Pass" : "Fail");
+        if (n >= 0 && (size_t)n < room)
+        {
+            chunk->reportLen += n;
+            return;
+        }
+
+        char *bigger = realloc(chunk->report, chunk->reportCap * 2);
+        if (bigger == NULL)
+        {
+            return; // Out of memory: the line is left out of the report
+        }
+        chunk->report = bigger;
+        chunk->reportCap *= 2;
+    }
+}
+
+// Reads one chunk per worker, classifies them in parallel, then writes the
+// reports in file order
+void classifyFile(const char *inName, const char *outName)
+{
+    FILE *in = fopen(inName, "r");
+    FILE *out = fopen(outName, "w");
+    struct StudentChunk *chunks[MAX_WORKERS] = {NULL};
+    long long total = 0, passed = 0, skipped = 0;
+    int workers = ttt_cpuCount();
+    int ok = (in != NULL && out != NULL);
+
+    if (workers > MAX_WORKERS)
+    {
+        workers = MAX_WORKERS;
+    }
+    for (int c = 0; c < workers && ok; c++)
+    {
+        chunks[c] = calloc(1, sizeof(struct StudentChunk));
+        ok = (chunks[c] != NULL);
+        if (ok)
+        {
+            chunks[c]->text = malloc(CHUNK_BYTES);
+            chunks[c]->reportCap = (size_t)CHUNK_RECORDS * 48;
+            chunks[c]->report = malloc(chunks[c]->reportCap);
+            ok = (chunks[c]->text != NULL && chunks[c]->report != NULL);
+        }
+    }
+
+    if (ok)
+    {
+        // Large stdio buffers turn the report into a few big writes
+        setvbuf(in, NULL, _IOFBF, IO_BUFFER);
+        setvbuf(out, NULL, _IOFBF, IO_BUFFER);
+        fprintf(out, "Name\tID\tCGPA\tStatus\n");
+
+        double start = ttt_wallSeconds();
+        for (;;)
+        {
+            Thread threads[MAX_WORKERS];
+            int started[MAX_WORKERS];
+            int filled = 0;
+
+            while (filled < workers && readChunk(in, chunks[filled]) > 0)
+            {
+                filled++;
+            }
+            if (filled == 0)
+            {
+                break;
+            }
+
+            // Chunk 0 is done here; a helper that fails to start has its chunk done here too
+            for (int c = 1; c < filled; c++)
+            {
+                started[c] = ttt_threadStart(&threads[c], processChunk, chunks[c]);
+            }
+            processChunk(chunks[0]);
+            for (int c = 1; c < filled; c++)
+            {
+                if (started[c])
+                {
+                    ttt_threadJoin(threads[c]);
+                }
+                else
+                {
+                    processChunk(chunks[c]);
+                }
+            }
+
+            for (int c = 0; c < filled; c++)
+            {
+                fwrite(chunks[c]->report, 1, chunks[c]->reportLen, out);
+                total += chunks[c]->count;
+                passed += chunks[c]->passed;
+                skipped += chunks[c]->skipped;
+            }
+        }
+        double seconds = ttt_wallSeconds() - start;
+
+        printf("%lld students: %lld Pass, %lld Fail", total, passed, total - passed);
+        if (skipped > 0)
+        {
+            printf(" (%lld bad lines skipped)", skipped);
+        }
+        printf("\n%.2f s, %.0f records/sec, %d threads\n", seconds, (seconds > 0) ? total / seconds : 0.0, workers);
+    }
+    else if (in == NULL || out == NULL)
+    {
+        printf("Cannot open %s or %s.\n", inName, outName);
+    }
+    else
+    {
+        printf("Not enough memory.\n");
+    }
+
+    if (in != NULL) fclose(in);
+    if (out != NULL) fclose(out);
+    for (int c = 0; c < workers; c++)
+    {
+        if (chunks[c] != NULL)
+        {
+            free(chunks[c]->text);
+            free(chunks[c]->report);
+            free(chunks[c]);
+        }
+    }
 }
 
 void prob5()
@@ -221,13 +690,46 @@ void prob5()
 
 void prinarray(int *ptr, int n)
 {
-    int i;
     printf("Printing an Array:\n");
-    for (i = 0; i < n; i++)
+    printArray(ptr, n, stdout);
+
+}
+
+// Formats the numbers into a local buffer and writes it out in large
+// blocks instead of one printf call per element
+void printArray(const int *arr, size_t n, FILE *out)
+{
+    static char buf[IO_BUFFER];
+    size_t used = 0;
+
+    for (size_t i = 0; i < n; i++)
     {
-        printf("%d\n",(*ptr+i));
-    }
+        char digits[12];
+        int len = 0;
+        unsigned int v = (arr[i] < 0) ? 0u - (unsigned int)arr[i] : (unsigned int)arr[i];
+
+        do
+        {
+            digits[len++] = '0' + v % 10;
+            v /= 10;
+        } while (v > 0);
 
+        if (used + len + 2 > sizeof(buf))
+        {
+            fwrite(buf, 1, used, out);
+            used = 0;
+        }
+        if (arr[i] < 0)
+        {
+            buf[used++] = '-';
+        }
+        while (len > 0)
+        {
+            buf[used++] = digits[--len];
+        }
+        buf[used++] = '\n';
+    }
+    fwrite(buf, 1, used, out);
 }
 
 void prob6()
@@ -244,3 +746,77 @@ void AreaCircle(int *r)
     float area =(float) pi *(*r * *r);
     printf("Area of circle:%f\n",area);
 }
+
+void prob7()
+{
+    size_t n = 1 << 26;     // 256 MB of ints, 64 MB of text
+    int *arr = malloc(n * sizeof(int));
+    char *text = malloc(n);
+    clock_t start;
+
+    if (arr == NULL || text == NULL)
+    {
+        printf("Not enough memory.\n");
+        free(arr);
+        free(text);
+        return;
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        arr[i] = (int)i;
+        text[i] = text[n - 1 - i] = 'a' + (i * 7) % 26;
+    }
+
+    printf("%-22s %-12s %-12s\n", "Kernel", "Loop (s)", "New (s)");
+
+    start = clock();
+    for (size_t i = 0; i < n / 2; i++)
+    {
+        int t = arr[i];
+        arr[i] = arr[n - 1 - i];
+        arr[n - 1 - i] = t;
+    }
+    double loop = (double)(clock() - start) / CLOCKS_PER_SEC;
+    start = clock();
+    reverseInPlace(arr, n);
+    double fast = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("%-22s %-12.3f %-12.3f %s\n", "Reverse 64M ints", loop, fast,
+           (arr[0] == 0 && arr[n - 1] == (int)(n - 1)) ? "" : "MISMATCH");
+
+    start = clock();
+    int flag = 1;
+    for (size_t i = 0, j = n - 1; i < j; i++, j--)
+    {
+        if (text[i] != text[j])
+        {
+            flag = 0;
+            break;
+        }
+    }
+    loop = (double)(clock() - start) / CLOCKS_PER_SEC;
+    start = clock();
+    int simd = isPalindrome(text, n);
+    fast = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("%-22s %-12.3f %-12.3f %s\n", "Palindrome 64 MB", loop, fast, (flag == simd) ? "" : "MISMATCH");
+
+    FILE *out = tmpfile();
+    if (out != NULL)
+    {
+        size_t count = 1 << 22;
+        start = clock();
+        for (size_t i = 0; i < count; i++)
+        {
+            fprintf(out, "%d\n", arr[i]);
+        }
+        loop = (double)(clock() - start) / CLOCKS_PER_SEC;
+        start = clock();
+        printArray(arr, count, out);
+        fast = (double)(clock() - start) / CLOCKS_PER_SEC;
+        printf("%-22s %-12.3f %-12.3f\n", "Print 4M ints", loop, fast);
+        fclose(out);
+    }
+
+    free(arr);
+    free(text);
+}
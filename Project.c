@@ -1,7 +1,22 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
+#include <math.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "tictactoe_internal.h"
 
 // -------------------------
 // Structure Definitions
@@ -14,41 +29,252 @@ typedef struct {
     int draws;
 } PlayerStats;
 
-typedef struct {
-    char *board;   // Dynamic 1D array for NxN board
-    int size;      // Board dimension (3x3 & 4x4)
-    int moves;     // Number of moves made
-    int status;    // 0 = ongoing, 1 = win, 2 = draw
-} Game;
-
 typedef struct {
     char player1[50];
     char player2[50];
     char winner[50];
     char timestamp[100];
     int boardSize;
-    int gameMode; // 1 = PVP, 2 = PVE
+    int gameMode; // 1 = PVP, 2 = PVE, 3 = EVE (bot tournament)
+    time_t playedAt; // Parsed from timestamp, used by the archive
 } MatchRecord;
 
+typedef struct {
+    uint64_t hash; // Position after the opponent's reply
+    int reply;     // Bot move prepared for that position
+} PonderEntry;
+
+typedef struct {
+    int games;
+    int wins;
+    int losses;
+    int draws;
+} EngineResult;
+
+// -------------------------
+// Statistics Definitions
+// -------------------------
+#define CACHE_LINE        64
+#define STAT_BENCH_THREADS 16 // Most threads the contention benchmark runs
+#define STAT_BENCH_UPDATES 20000000
+#define STAT_ENGINE_BASE  4   // Bot engines follow Host, Guest, Player and Bot
+#define STAT_PLAYERS      (STAT_ENGINE_BASE + MAX_ENGINES)
+
+// Counters one game runner adds to; the padding keeps the next shard's
+// counters off the cache line holding the end of this one
+typedef struct {
+    int matches[STAT_PLAYERS];
+    int wins[STAT_PLAYERS];
+    int losses[STAT_PLAYERS];
+    int draws[STAT_PLAYERS];
+    char pad[CACHE_LINE];
+} StatShard;
+
+// The counters one runner touches in a game, packed with nothing
+// around them: the layout per-thread results get without padding, where
+// two runners' counters share each cache line
+typedef struct {
+    int matches[2];
+    int wins[2];
+    int losses[2];
+    int draws[2];
+} SeatCounters;
+
+// -------------------------
+// Tournament Definitions
+// -------------------------
+#define TOURNAMENT_SIZES  4   // 3x3, 4x4, Qubic and Gomoku
+
+// Games between two engines on one board with fixed colours
+typedef struct {
+    int x;               // Engine index playing X in every game
+    int o;               // Engine index playing O
+    int boardSize;
+    EngineResult result; // From X's side
+} TournamentSeries;
+
+// Games of a round handed out one at a time to the worker threads
+typedef struct {
+    TournamentSeries *series;
+    int seriesCount;
+    int rounds;          // Games per series
+    int nextGame;        // First game nobody has claimed yet
+    uint64_t seed;       // Game n is seeded with seed + n, whichever thread plays it
+    Mutex lock;          // Guards nextGame and the series results
+} TournamentPool;
+
+typedef struct {
+    TournamentPool *pool;
+    StatShard *shard;    // Where this worker records its games
+} TournamentWorker;
+
+// -------------------------
+// Turn Definitions
+// -------------------------
+// Result of a player's turn
+#define MOVE_PLAYED       0
+#define MOVE_UNDO         1
+#define MOVE_REDO         2
+
+// -------------------------
+// Pondering Definitions
+// -------------------------
+#define PONDER_REPLIES    16  // Likely opponent replies prepared per turn
+
+// The ponder thread searches its own copy of the position, so the game's
+// undo/redo history is never touched while the player is thinking
+typedef struct {
+    Game game;
+    char botSymbol;
+    int stop;            // Set once the player has entered a move
+    Mutex lock;          // Guards stop
+} PonderJob;
+
+// -------------------------
+// State-Space Enumerator Definitions
+// -------------------------
+#define ENUM_MAX_SIZE      5          // Positions are packed as X | O << 32
+#define ENUM_TABLE_SLOTS   (1 << 23)  // Largest shared hash set of new positions (64 MB)
+#define ENUM_TABLE_MIN     (1 << 12)  // Smallest set, used while a ply has few positions
+#define ENUM_PARENT_BATCH  (1 << 18)  // Frontier positions expanded per batch
+#define ENUM_CLAIM         256        // Frontier positions a worker takes at a time
+#define ENUM_MAX_RUNS      64         // Runs merged at once; more are merged in passes
+#define ENUM_MAX_THREADS   64
+#define ENUM_READ_CHUNK    1024
+
+typedef struct {
+    FILE *file;
+    uint64_t keys[ENUM_READ_CHUNK];
+    int pos;
+    int len;
+} EnumRun;
+
+// One batch of frontier positions expanded by the worker threads into the
+// shared set; 0 marks a free slot, since no child is the empty board
+typedef struct {
+    volatile uint64_t *table;
+    uint64_t mask;       // Slots in use this ply, minus one
+    const uint64_t *parents;
+    int parentCount;
+    int nextParent;      // First parent nobody has claimed yet
+    int cells;
+    int shift;           // 0 when X moves, 32 when O moves
+    int (*symmetry)[ENUM_MAX_SIZE * ENUM_MAX_SIZE];
+    uint64_t inserted;   // Keys that were new to the set
+    uint64_t generated;  // Successors produced, duplicates included
+    Mutex lock;          // Guards nextParent and the totals
+} EnumBatch;
+
+// -------------------------
+// History Archive Definitions
+// -------------------------
+#define HISTORY_SEGMENT_CAP   50  // Matches kept in game_data.txt before rotating
+#define ARCHIVE_BATCH         40  // Oldest matches moved into each archive segment
+#define ARCHIVE_MAX_NAMES     255
+#define ARCHIVE_MANIFEST      "history_manifest.txt"
+#define PERSIST_BATCH         8   // Finished matches committed to disk together
+#define PERSIST_QUEUE         64  // Matches that can wait for the writer thread
+#define PERSIST_COMMITS       4   // Commit requests that can wait for it
+
+// Failures the writer thread leaves for the game thread to report
+#define PERSIST_STATS_FAILED    1
+#define PERSIST_ARCHIVE_FAILED  2
+#define PERSIST_MANIFEST_FAILED 4
+
+// A commit covers every match queued before `end`, written together with
+// the statistics as they stood once those matches were recorded
+typedef struct {
+    PlayerStats stats[STAT_PLAYERS];
+    uint64_t end;
+} CommitRequest;
+
+// Matches and commit requests waiting for the writer thread, which does
+// all of the file I/O. Both are ring buffers with one producer (the game
+// thread) and one consumer (the writer), so neither needs a lock: each
+// side advances only its own counter, with a release store that makes the
+// slots it filled or emptied visible to the other side. The lock and
+// conditions are only used to sleep while a ring is empty or full.
+typedef struct {
+    MatchRecord matches[PERSIST_QUEUE];
+    CommitRequest commits[PERSIST_COMMITS];
+    volatile uint64_t matchHead;        // Matches queued so far
+    volatile uint64_t matchTail;        // Matches written so far
+    volatile uint64_t commitHead;       // Commits requested so far
+    volatile uint64_t commitTail;       // Commits finished so far
+    volatile uint64_t errors;           // PERSIST_* failures not yet reported
+    volatile uint64_t shutdown;
+    uint64_t requestedEnd;              // End of the latest commit request (game thread)
+    int threaded;                       // 0 if the writer did not start; commits then run inline
+    MatchRecord batch[PERSIST_QUEUE];   // The batch being written
+    Thread thread;
+    Mutex lock;
+    Condition wake;                     // Wakes the writer
+    Condition progress;                 // Queue space freed or a commit finished
+} PersistQueue;
+
 // -------------------------
 // Global Variables
 // -------------------------
-PlayerStats gameStats[4]; // Host, Guest, Player, Bot
+PlayerStats gameStats[STAT_PLAYERS]; // Host, Guest, Player, Bot, then the bot engines
+
+// Results recorded since the last merge into gameStats; the interactive
+// game records into shard 0, tournament workers into the others. There is
+// one shard per processor besides shard 0, sized at startup.
+StatShard *statShards;
+int statShardCount = 0;
 int currentBoardSize = 3;
 
+// Finished matches waiting for the next group commit
+PersistQueue persist;
+
+// Bot replies prepared while the player was choosing a move
+PonderEntry ponderCache[PONDER_REPLIES];
+int ponderCount = 0;
+
 // -------------------------
 // Function Prototypes
 // -------------------------
-void initializeBoard(Game *game, int size);
+// Board Display Functions
 void printBoard(Game *game);
-int checkWinner(Game *game, char symbol);
-int isDraw(Game *game);
-void freeBoard(Game *game);
-int isValidMove(Game *game, int move);
+void printQubicBoard(Game *game);
+void printLargeBoard(Game *game);
 
 // Move Functions
-void playerMove(Game *game, char symbol, const char *playerName);
+int playerMove(Game *game, char symbol, const char *playerName, char botSymbol);
 void botMove(Game *game, char symbol);
+BotEngine *pveEngine(Game *game);
+
+// Pondering Functions
+int startPonder(PonderJob *job, Game *game, char botSymbol, Thread *thread);
+void stopPonder(PonderJob *job, Thread thread);
+int ponderStopped(PonderJob *job);
+void *ponderReplies(void *arg);
+int lookupPonder(Game *game);
+
+// Tournament Functions
+void displayToolsMenu();
+void runTournament();
+void benchmarkWinCheck();
+void benchmarkRollouts();
+void trainLearnedEngine();
+int playBotGame(BotEngine *xEngine, BotEngine *oEngine, int boardSize, uint64_t seed);
+void playTournamentRound(int pairs[][2], int pairCount, int rounds, uint64_t seed, EngineResult results[MAX_ENGINES]);
+void *tournamentWorker(void *arg);
+int swissPairings(EngineResult results[MAX_ENGINES], int met[MAX_ENGINES][MAX_ENGINES], int pairs[][2]);
+
+// State-Space Enumerator Functions
+void enumerateStates();
+uint64_t canonicalKey(uint64_t key, int cells, int symmetry[8][ENUM_MAX_SIZE * ENUM_MAX_SIZE]);
+int compareKeys(const void *a, const void *b);
+uint64_t expandBatch(EnumBatch *batch, int threads);
+void *expandWorker(void *arg);
+int insertKey(volatile uint64_t *table, uint64_t mask, uint64_t key);
+int spillTable(uint64_t *table, uint64_t slots, EnumRun *runs, int *runCount);
+int spillRun(uint64_t *buffer, int count, EnumRun *runs, int *runCount);
+int refillRun(EnumRun *run);
+void rewindRuns(EnumRun *runs, int runCount);
+int nextMergedKey(EnumRun *runs, int runCount, uint64_t *key);
+int compactRuns(EnumRun *runs, int *runCount);
 
 // Menu and Game Flow
 void displayMainMenu();
@@ -58,34 +284,75 @@ int selectFirstPlayer(int mode);
 void playGame(int mode, int firstPlayer, int boardSize);
 
 // Statistics Functions
-void loadStats(PlayerStats stats[4]);
-void saveStats(PlayerStats stats[4]);
-void displayStats(PlayerStats stats[4]);
-void updateStats(PlayerStats stats[4], int winner, int mode);
+void loadStats(PlayerStats stats[STAT_PLAYERS]);
+int saveStats(PlayerStats stats[STAT_PLAYERS], MatchRecord *matches, int count);
+void displayStats(PlayerStats stats[STAT_PLAYERS]);
+void updateStats(StatShard *shard, int winner, int mode);
+void updateEngineStats(StatShard *shard, int xEngine, int oEngine, int winner);
+void mergeStats(PlayerStats stats[STAT_PLAYERS]);
+void benchmarkStatShards();
+void updateSeatCounters(SeatCounters *seats, int winner, int mode);
 
 // Match History Functions
 void saveMatchResult(const char *p1, const char *p2, const char *winner, int mode, int boardSize);
+void commitMatches(int force);
+void flushMatches();
+int runCommit();
+void reportPersistErrors();
+void startPersistWriter();
+void stopPersistWriter();
+void *persistWriter(void *arg);
 void displayMatchHistory();
 void displayFullStats();
+void writeMatchRecord(FILE *file, MatchRecord *record);
+int rotateMatchHistory();
+int closeSynced(FILE *file);
+int replaceFile(const char *temp, const char *target);
+
+// History Archive Functions
+time_t parseTimestamp(const char *text);
+void putVarint(FILE *file, uint64_t value);
+uint64_t getVarint(FILE *file);
+int archiveNameIndex(char names[][50], int *nameCount, const char *name);
+int writeArchiveSegment(const char *filename, MatchRecord *records, int count);
+int readArchiveSegment(const char *filename, MatchRecord **records);
+int appendManifestEntry(const char *segmentName, MatchRecord *records, int count);
+int sameMatches(MatchRecord *a, MatchRecord *b, int count);
+void displayArchivedHistory();
 
 // Utility Functions
 void clearInputBuffer();
 void getCurrentTimestamp(char *buffer);
+void trimTrailingSpaces(char *text);
 
 // -------------------------
 // Main Function
 // -------------------------
 int main() {
     srand(time(NULL));
+    tictactoeInit();
+    tictactoeLoadWeights(EVAL_WEIGHTS_FILE);
+
+    // Shard 0 for the interactive game, one per tournament worker
+    statShardCount = 1 + ttt_cpuCount();
+    statShards = (StatShard *)calloc(statShardCount, sizeof(StatShard));
+    if (statShards == NULL) {
+        printf("Error: Out of memory!\n");
+        return 1;
+    }
 
     // Initialize player names
     strcpy(gameStats[0].name, "Host");
     strcpy(gameStats[1].name, "Guest");
     strcpy(gameStats[2].name, "Player");
     strcpy(gameStats[3].name, "Bot");
+    for (int i = 0; i < ttt_numBotEngines; i++) {
+        strcpy(gameStats[STAT_ENGINE_BASE + i].name, ttt_botEngines[i].name);
+    }
 
     // Load existing statistics
     loadStats(gameStats);
+    startPersistWriter();
 
     int choice;
     int gameMode;
@@ -125,47 +392,45 @@ int main() {
                 break;
 
             case 4:
+                displayToolsMenu();
+                break;
+
+            case 5:
                 printf("Your progress has been successfully saved.\n");
                 printf("Goodbye!\n");
-                saveStats(gameStats);
+                stopPersistWriter();
                 break;
 
             default:
                 printf("Invalid choice! Please try again.\n");
         }
 
-        if(choice != 4) {
+        if(choice != 5) {
             printf("\nPress Enter to continue...");
             getchar();
         }
 
-    } while(choice != 4);
+    } while(choice != 5);
 
+    free(statShards);
     return 0;
 }
 
 // -------------------------
-// Game Core Functions
+// Board Display Functions
 // -------------------------
-void initializeBoard(Game *game, int size) {
-    game->size = size;
-    game->moves = 0;
-    game->status = 0;
-    game->board = (char *)malloc(size * size * sizeof(char));
-
-    // Initialize with position numbers (1, 2, 3, ...)
-    for (int i = 0; i < size * size; i++) {
-        if (i < 9) {
-            game->board[i] = '1' + i;
-        } else {
-            game->board[i] = 'A' + (i - 9); // Alphabets represent Hexadecimal Values
-        }
-    }
-}
-
 void printBoard(Game *game) {
     int size = game->size;
 
+    if (game->layers > 1) {
+        printQubicBoard(game);
+        return;
+    }
+    if (size > 4) {
+        printLargeBoard(game);
+        return;
+    }
+
     printf("\n");
     for (int i = 0; i < size; i++) {
         printf("   ");
@@ -187,110 +452,229 @@ void printBoard(Game *game) {
     printf("\n");
 }
 
-int checkWinner(Game *game, char symbol) {
+// Boards too wide for labelled cells show '.' with the position number of
+// each row's first cell on the left and column offsets on top
+void printLargeBoard(Game *game) {
     int size = game->size;
 
-    // Check rows
-    for (int i = 0; i < size; i++) {
-        int count = 0;
-        for (int j = 0; j < size; j++) {
-            if (game->board[i * size + j] == symbol)
-                count++;
-        }
-        if (count == size) return 1;
+    printf("\n      ");
+    for (int col = 0; col < size; col++) {
+        printf("%3d", col);
     }
+    printf("\n");
 
-    // Check columns
-    for (int j = 0; j < size; j++) {
-        int count = 0;
-        for (int i = 0; i < size; i++) {
-            if (game->board[i * size + j] == symbol)
-                count++;
+    for (int row = 0; row < size; row++) {
+        printf("  %4d", row * size + 1);
+        for (int col = 0; col < size; col++) {
+            char cell = game->board[row * size + col];
+            printf("  %c", (cell == 'X' || cell == 'O') ? cell : '.');
         }
-        if (count == size) return 1;
+        printf("\n");
     }
+    printf("\n");
+}
 
-    // Check main diagonal
-    int count = 0;
-    for (int i = 0; i < size; i++) {
-        if (game->board[i * size + i] == symbol)
-            count++;
+void printQubicBoard(Game *game) {
+    printf("\n");
+    for (int layer = 0; layer < 4; layer++) {
+        printf("   Layer %d          ", layer + 1);
     }
-    if (count == size) return 1;
+    printf("\n");
 
-    // Check anti-diagonal
-    count = 0;
-    for (int i = 0; i < size; i++) {
-        if (game->board[i * size + (size - 1 - i)] == symbol)
-            count++;
+    for (int row = 0; row < 4; row++) {
+        for (int layer = 0; layer < 4; layer++) {
+            printf("  ");
+            for (int col = 0; col < 4; col++) {
+                int index = layer * 16 + row * 4 + col;
+                char cell = game->board[index];
+                if (cell == 'X' || cell == 'O') {
+                    printf("  %c", cell);
+                } else {
+                    printf(" %2d", index + 1);
+                }
+                if (col < 3) printf(" ");
+            }
+            printf("   ");
+        }
+        printf("\n");
     }
-    if (count == size) return 1;
-
-    return 0;
-}
-
-int isDraw(Game *game) {
-    return (game->moves == game->size * game->size);
-}
-
-void freeBoard(Game *game) {
-    free(game->board);
-    game->board = NULL;
-}
-
-int isValidMove(Game *game, int move) {
-    int maxPos = game->size * game->size;
-    if (move < 1 || move > maxPos) return 0;
-
-    char pos = game->board[move - 1];
-    return (pos != 'X' && pos != 'O');
+    printf("\n");
 }
 
 // -------------------------
 // Move Functions
 // -------------------------
-void playerMove(Game *game, char symbol, const char *playerName) {
+// botSymbol is the bot's symbol in PVE (the bot ponders while we wait), or 0
+int playerMove(Game *game, char symbol, const char *playerName, char botSymbol) {
     int move;
     int validMove = 0;
-    int maxPos = game->size * game->size;
+    int maxPos = game->cells;
+    PonderJob ponder;
+    Thread ponderThread;
 
     do {
+        int pondering = 0;
+
         printf("%s's turn (%c)\n", playerName, symbol);
-        printf("Enter position (1-%d): ", maxPos);
+        printf("Enter position (1-%d, 0 = undo, -1 = redo): ", maxPos);
+        fflush(stdout);
+        if (botSymbol != 0) {
+            pondering = startPonder(&ponder, game, botSymbol, &ponderThread);
+        }
         scanf("%d", &move);
         clearInputBuffer();
+        if (pondering) {
+            stopPonder(&ponder, ponderThread);
+        }
 
-        if (isValidMove(game, move)) {
-            game->board[move - 1] = symbol;
-            game->moves++;
+        if (move == 0) {
+            return MOVE_UNDO;
+        } else if (move == -1) {
+            return MOVE_REDO;
+        } else if (isValidMove(game, move)) {
+            makeMove(game, move, symbol);
             validMove = 1;
         } else {
             printf("Invalid move! Position must be between 1-%d and not already taken.\n", maxPos);
         }
     } while (!validMove);
+
+    return MOVE_PLAYED;
 }
 
 void botMove(Game *game, char symbol) {
     int move;
-    int maxPos = game->size * game->size;
 
-    printf("Bot is thinking");
-    for(int i = 0; i < 3; i++) {
-        printf(".");
-        fflush(stdout);
-        for(int j = 0; j < 100000000; j++);
+    // No artificial delay: a pondered reply comes back at once, and the
+    // search takes the time it takes
+    printf("Bot is thinking...\n");
+    fflush(stdout);
+
+    // Use the reply prepared during the player's turn when there is one
+    move = lookupPonder(game);
+    if (move == 0) {
+        move = chooseEngineMove(game, symbol, pveEngine(game));
     }
-    printf("\n");
+    makeMove(game, move, symbol);
 
-    // Simple random AI
-    do {
-        move = rand() % maxPos + 1;
-    } while (!isValidMove(game, move));
+    printf("Bot chose position %d\n", move);
+}
+
+// Simple random AI on 3x3; the boards too large to solve get the search
+// with the learned evaluator at its leaves, and Gomoku the threat engine
+BotEngine *pveEngine(Game *game) {
+    if (game->size == GOMOKU_SIZE) {
+        return findEngine(ENGINE_THREAT);
+    } else if (game->layers > 1 || game->size == 4) {
+        return findEngine(ENGINE_LEARNED);
+    }
+    return findEngine(ENGINE_RANDOM);
+}
+
+// -------------------------
+// Pondering Functions
+// -------------------------
+// Replays the game onto a fresh board and starts the ponder thread on it;
+// returns 0 if the thread could not start, and the bot then simply thinks
+// on its own turn
+int startPonder(PonderJob *job, Game *game, char botSymbol, Thread *thread) {
+    initializeBoard(&job->game, currentBoardSize);
+    for (int i = 0; i < game->historyTop; i++) {
+        makeMove(&job->game, game->history[i].cell + 1, game->history[i].symbol);
+    }
+    job->game.rng = game->rng;
+    job->botSymbol = botSymbol;
+    job->stop = 0;
+    ttt_mutexInit(&job->lock);
+    ponderCount = 0;
 
-    game->board[move - 1] = symbol;
-    game->moves++;
+    if (ttt_threadStart(thread, ponderReplies, job)) return 1;
 
-    printf("Bot chose position %d\n", move);
+    ttt_mutexDestroy(&job->lock);
+    freeBoard(&job->game);
+    return 0;
+}
+
+// Called once the player has entered something; the thread finishes the
+// reply it is working on, and its cache is ready for lookupPonder
+void stopPonder(PonderJob *job, Thread thread) {
+    ttt_mutexLock(&job->lock);
+    job->stop = 1;
+    ttt_mutexUnlock(&job->lock);
+
+    ttt_threadJoin(thread);
+    ttt_mutexDestroy(&job->lock);
+    freeBoard(&job->game);
+}
+
+int ponderStopped(PonderJob *job) {
+    ttt_mutexLock(&job->lock);
+    int stop = job->stop;
+    ttt_mutexUnlock(&job->lock);
+    return stop;
+}
+
+// Runs on the player's time: until the player moves, the bot works out its
+// answer to the most promising replies, one reply per slice, and keeps them
+// keyed by position hash. Whichever reply the player actually makes, a
+// matching entry lets the bot answer at once.
+void *ponderReplies(void *arg) {
+    PonderJob *job = (PonderJob *)arg;
+    Game *game = &job->game;
+    char botSymbol = job->botSymbol;
+    char playerSymbol = (botSymbol == 'X') ? 'O' : 'X';
+    int playerSide = (playerSymbol == 'X') ? 0 : 1;
+    BotEngine *engine = pveEngine(game);
+    int replies[PONDER_REPLIES];
+    int scores[PONDER_REPLIES];
+    int count = 0;
+
+    if (engine->type == ENGINE_RANDOM) return NULL; // Nothing worth preparing
+
+    // Rank the player's replies by the pattern score they would reach
+    for (int cell = 0; cell < game->cells; cell++) {
+        if (!isValidMove(game, cell + 1) || !isNearStone(game, cell)) continue;
+
+        makeMove(game, cell + 1, playerSymbol);
+        int score = patternScore(game, playerSide) - patternScore(game, 1 - playerSide);
+        int won = lastMoveWins(game);
+        unmakeMove(game);
+        if (won) continue; // The game would be over; no reply needed
+
+        int pos = (count < PONDER_REPLIES) ? count++ : PONDER_REPLIES;
+        while (pos > 0 && scores[pos - 1] < score) {
+            if (pos < PONDER_REPLIES) {
+                replies[pos] = replies[pos - 1];
+                scores[pos] = scores[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < PONDER_REPLIES) {
+            replies[pos] = cell + 1;
+            scores[pos] = score;
+        }
+    }
+
+    for (int i = 0; i < count && !ponderStopped(job); i++) {
+        makeMove(game, replies[i], playerSymbol);
+        if (!isDraw(game)) {
+            ponderCache[ponderCount].hash = game->hash;
+            ponderCache[ponderCount].reply = chooseEngineMove(game, botSymbol, engine);
+            ponderCount++;
+        }
+        unmakeMove(game);
+    }
+
+    return NULL;
+}
+
+int lookupPonder(Game *game) {
+    for (int i = 0; i < ponderCount; i++) {
+        if (ponderCache[i].hash == game->hash && isValidMove(game, ponderCache[i].reply)) {
+            return ponderCache[i].reply;
+        }
+    }
+    return 0;
 }
 
 // -------------------------
@@ -301,7 +685,8 @@ void displayMainMenu() {
     printf("1. Start New Game\n");
     printf("2. View Game Statistics\n");
     printf("3. View Match History\n");
-    printf("4. Exit\n");
+    printf("4. Engine Tools\n");
+    printf("5. Exit\n");
 }
 
 int selectBoardSize() {
@@ -309,14 +694,16 @@ int selectBoardSize() {
     printf("\nSelect Board Size:\n");
     printf("3. Classic 3x3\n");
     printf("4. Standard 4x4\n");
-    printf("Enter board size (3-4): ");
+    printf("5. Qubic 4x4x4 (3D)\n");
+    printf("6. Gomoku 15x15 (5 in a row)\n");
+    printf("Enter board size (3-6): ");
     scanf("%d", &size);
     clearInputBuffer();
 
-    if (size >= 3 && size <= 4) {
+    if (size >= 3 && size <= 6) {
         return size;
     } else {
-        printf("Invalid size! Please choose between 3 and 4.\n");
+        printf("Invalid size! Please choose between 3 and 6.\n");
         return -1;
     }
 }
@@ -370,9 +757,11 @@ void playGame(int mode, int firstPlayer, int boardSize) {
     int winner = 0;
 
     initializeBoard(&game, boardSize);
+    seedGame(&game, (uint64_t)rand());
+    ponderCount = 0;
 
     printf("\n=== GAME STARTED ===\n");
-    printf("Board Size: %dx%d\n", boardSize, boardSize);
+    printf("Board Size: %s\n", boardSizeName(boardSize));
 
     if (mode == 1) {
         printf("Mode: PVP - Host (X) vs Guest (O)\n");
@@ -382,22 +771,38 @@ void playGame(int mode, int firstPlayer, int boardSize) {
 
     // Game loop
     while (game.status == 0) {
+        int action = MOVE_PLAYED;
+
         printBoard(&game);
 
         if (mode == 1) { // PVP mode
             if (currentPlayer == 1) {
-                playerMove(&game, 'X', "Host");
+                action = playerMove(&game, 'X', "Host", 0);
             } else {
-                playerMove(&game, 'O', "Guest");
+                action = playerMove(&game, 'O', "Guest", 0);
             }
         } else { // PVE mode
             if (currentPlayer == 1) {
-                playerMove(&game, 'X', "Player");
+                action = playerMove(&game, 'X', "Player", 'O');
             } else {
                 botMove(&game, 'O');
             }
         }
 
+        // Undo/redo steps back a full turn: one move in PVP, the player's
+        // and the bot's move in PVE, so it is the same player's turn again
+        if (action != MOVE_PLAYED) {
+            int steps = (mode == 1) ? 1 : 2;
+            int done = (action == MOVE_UNDO) ? undoMoves(&game, steps) : redoMoves(&game, steps);
+
+            if (!done) {
+                printf("Nothing to %s!\n", (action == MOVE_UNDO) ? "undo" : "redo");
+            } else if (steps == 1) {
+                currentPlayer = (currentPlayer == 1) ? 2 : 1;
+            }
+            continue;
+        }
+
         // Check for winner
         char currentSymbol = (currentPlayer == 1) ? 'X' : 'O';
         if (checkWinner(&game, currentSymbol)) {
@@ -429,231 +834,1541 @@ void playGame(int mode, int firstPlayer, int boardSize) {
         currentPlayer = (currentPlayer == 1) ? 2 : 1;
     }
 
-    // Update statistics
-    updateStats(gameStats, winner, mode);
-    saveStats(gameStats);
+    // Update statistics, then commit; the match and its result reach disk together
+    updateStats(&statShards[0], winner, mode);
+    commitMatches(0);
 
     freeBoard(&game);
 }
 
 // -------------------------
-// Statistics Functions
+// Engine Tools and Tournament Functions
 // -------------------------
-void loadStats(PlayerStats stats[4]) {
-    FILE *file = fopen("game_stats.txt", "r");
+void displayToolsMenu() {
+    int choice;
+    printf("\n=== ENGINE TOOLS ===\n");
+    printf("1. Bot Tournament (round-robin or Swiss)\n");
+    printf("2. Win Check Benchmark\n");
+    printf("3. State-Space Enumerator\n");
+    printf("4. Rollout Benchmark\n");
+    printf("5. Train Learned Evaluator\n");
+    printf("6. Stats Contention Benchmark\n");
+    printf("0. Back\n");
+    printf("Enter choice: ");
+    scanf("%d", &choice);
+    clearInputBuffer();
 
-    if (file == NULL) {
-        for (int i = 0; i < 4; i++) {
-            stats[i].matches = 0;
-            stats[i].wins = 0;
-            stats[i].losses = 0;
-            stats[i].draws = 0;
-        }
-        return;
+    switch (choice) {
+        case 0:
+            break;
+        case 1:
+            runTournament();
+            break;
+        case 2:
+            benchmarkWinCheck();
+            break;
+        case 3:
+            enumerateStates();
+            break;
+        case 4:
+            benchmarkRollouts();
+            break;
+        case 5:
+            trainLearnedEngine();
+            break;
+        case 6:
+            benchmarkStatShards();
+            break;
+        default:
+            printf("Invalid choice!\n");
     }
+}
 
-    char line[200];
-    int lineCount = 0;
-    int playerIndex = 0;
+// The same seed replays the same game, as long as neither engine is bound
+// by the clock (the threat engine stops searching when its budget runs out)
+int playBotGame(BotEngine *xEngine, BotEngine *oEngine, int boardSize, uint64_t seed) {
+    Game game;
+    char symbol = 'X';
+    int winner = 0;
 
-    while (fgets(line, sizeof(line), file) != NULL && playerIndex < 4) {
-        lineCount++;
-        if (lineCount <= 3) continue;
+    initializeBoard(&game, boardSize);
+    seedGame(&game, seed);
 
-        sscanf(line, "%s %d %d %d %d",
-               stats[playerIndex].name, &stats[playerIndex].matches,
-               &stats[playerIndex].wins, &stats[playerIndex].losses,
-               &stats[playerIndex].draws);
-        playerIndex++;
-    }
+    while (game.status == 0) {
+        BotEngine *engine = (symbol == 'X') ? xEngine : oEngine;
+        makeMove(&game, chooseEngineMove(&game, symbol, engine), symbol);
 
-    while (playerIndex < 4) {
-        stats[playerIndex].matches = 0;
-        stats[playerIndex].wins = 0;
-        stats[playerIndex].losses = 0;
-        stats[playerIndex].draws = 0;
-        playerIndex++;
+        if (lastMoveWins(&game)) {
+            game.status = 1;
+            winner = (symbol == 'X') ? 1 : 2;
+        } else if (isDraw(&game)) {
+            game.status = 2;
+        }
+        symbol = (symbol == 'X') ? 'O' : 'X';
     }
 
-    fclose(file);
+    freeBoard(&game);
+    return winner;
 }
 
-void saveStats(PlayerStats stats[4]) {
-    // First read existing match history if it exists
-    FILE *existingFile = fopen("game_data.txt", "r");
-    FILE *tempFile = fopen("temp_history_backup.txt", "w");
+void runTournament() {
+    int format;
+    int rounds;
+    int swissRounds = 0;
+    unsigned long seed;
+    int pairs[MAX_ENGINES * MAX_ENGINES / 2][2];
+    int pairCount = 0;
+    EngineResult results[MAX_ENGINES];
+
+    printf("\n=== BOT TOURNAMENT ===\n");
+    printf("1. Round-robin\n");
+    printf("2. Swiss\n");
+    printf("Enter format: ");
+    scanf("%d", &format);
+    clearInputBuffer();
 
-    if (existingFile != NULL && tempFile != NULL) {
-        char line[200];
-        int foundHistorySection = 0;
+    if (format != 1 && format != 2) {
+        printf("Invalid choice!\n");
+        return;
+    }
+    if (format == 2) {
+        printf("Swiss rounds: ");
+        scanf("%d", &swissRounds);
+        clearInputBuffer();
 
-        // Look for match history section and save it
-        while (fgets(line, sizeof(line), existingFile) != NULL) {
-            if (strstr(line, "=== MATCH HISTORY ===") != NULL) {
-                foundHistorySection = 1;
-            }
-            if (foundHistorySection) {
-                fprintf(tempFile, "%s", line);
-            }
+        if (swissRounds < 1) {
+            printf("Invalid number of rounds!\n");
+            return;
         }
-        fclose(existingFile);
-        fclose(tempFile);
-    } else if (tempFile != NULL) {
-        fclose(tempFile);
-    }
-    if (existingFile != NULL) {
-        fclose(existingFile);
     }
 
-    // Now write the complete file
-    FILE *file = fopen("game_data.txt", "w");
-    if (file == NULL) {
-        printf("Error: Unable to save statistics!\n");
+    printf("Games per pairing, board size and colour: ");
+    scanf("%d", &rounds);
+    clearInputBuffer();
+
+    if (rounds < 1) {
+        printf("Invalid number of games!\n");
         return;
     }
 
-    // Write Game Statistics
-    fprintf(file, "=== GAME STATISTICS ===\n");
-    fprintf(file, "%-10s %-8s %-6s %-8s %-7s %-8s\n", "Player", "Matches", "Wins", "Losses", "Draws", "Win Rate");
-    fprintf(file, "--------------------------------------------------------\n");
+    printf("Seed (0 = from the clock): ");
+    if (scanf("%lu", &seed) != 1) seed = 0;
+    clearInputBuffer();
 
-    for (int i = 0; i < 4; i++) {
-        float winRate = (stats[i].matches > 0) ?
-                       ((float)stats[i].wins / stats[i].matches * 100) : 0.0;
-        fprintf(file, "%-10s %-8d %-6d %-8d %-7d %.1f%%\n",
-                stats[i].name, stats[i].matches,
-                stats[i].wins, stats[i].losses, stats[i].draws, winRate);
-    }
+    if (seed == 0) seed = (unsigned long)time(NULL);
+    printf("Seed: %lu\n", seed);
 
-    fprintf(file, "\n");
+    memset(results, 0, sizeof(results));
+    double start = ttt_wallSeconds();
 
-    // Append existing match history
-    FILE *historyFile = fopen("temp_history_backup.txt", "r");
-    if (historyFile != NULL) {
-        char line[200];
-        while (fgets(line, sizeof(line), historyFile) != NULL) {
-            fprintf(file, "%s", line);
+    if (format == 1) {
+        // Round-robin: every pair of engines meets once
+        for (int a = 0; a < ttt_numBotEngines; a++) {
+            for (int b = a + 1; b < ttt_numBotEngines; b++) {
+                pairs[pairCount][0] = a;
+                pairs[pairCount][1] = b;
+                pairCount++;
+            }
         }
-        fclose(historyFile);
+        playTournamentRound(pairs, pairCount, rounds, seed, results);
     } else {
-        // If no existing history, create the section
-        fprintf(file, "=== MATCH HISTORY ===\n");
+        int met[MAX_ENGINES][MAX_ENGINES];
+
+        memset(met, 0, sizeof(met));
+        for (int r = 0; r < swissRounds; r++) {
+            printf("\n--- Round %d ---\n", r + 1);
+            pairCount = swissPairings(results, met, pairs);
+            // Rounds draw from separate seed ranges
+            playTournamentRound(pairs, pairCount, rounds, seed + ((uint64_t)r << 32), results);
+        }
     }
 
-    fclose(file);
-
-    // Remove temporary file
-    remove("temp_history_backup.txt");
+    printf("\nPlayed in %.1f s\n", ttt_wallSeconds() - start);
+    printf("\n%-12s %-7s %-6s %-8s %-7s %-8s %-8s\n", "Engine", "Games", "Wins", "Losses", "Draws", "Score", "95% CI");
+    printf("--------------------------------------------------------------\n");
+
+    for (int i = 0; i < ttt_numBotEngines; i++) {
+        int n = results[i].games;
+        float score = (n > 0) ? (results[i].wins + 0.5f * results[i].draws) / n : 0.0f;
+        float margin = (n > 0) ? 1.96f * sqrtf(score * (1.0f - score) / n) : 0.0f;
+        printf("%-12s %-7d %-6d %-8d %-7d %5.1f%%   +/-%.1f%%\n",
+               ttt_botEngines[i].name, n, results[i].wins, results[i].losses,
+               results[i].draws, score * 100, margin * 100);
+    }
 }
 
-void displayStats(PlayerStats stats[4]) {
-    printf("\n=== GAME STATISTICS ===\n");
-    printf("%-10s %-8s %-6s %-8s %-7s %-8s\n", "Player", "Matches", "Wins", "Losses", "Draws", "Win Rate");
-    printf("--------------------------------------------------------\n");
+// Every pair meets on every board size, playing the same number of games
+// with each colour. The games run on one thread per core; the results are
+// totalled and recorded afterwards, in pairing order.
+void playTournamentRound(int pairs[][2], int pairCount, int rounds, uint64_t seed, EngineResult results[MAX_ENGINES]) {
+    int sizes[TOURNAMENT_SIZES] = {3, 4, QUBIC_BOARD, GOMOKU_BOARD};
+    TournamentPool pool;
+    int started = 0;
+
+    pool.seriesCount = pairCount * TOURNAMENT_SIZES * 2;
+    pool.series = (TournamentSeries *)calloc(pool.seriesCount, sizeof(TournamentSeries));
+    TournamentWorker *workers = (TournamentWorker *)calloc(statShardCount, sizeof(TournamentWorker));
+    Thread *helpers = (Thread *)calloc(statShardCount, sizeof(Thread));
+    if (pool.series == NULL || workers == NULL || helpers == NULL) {
+        printf("Error: Out of memory!\n");
+        free(pool.series);
+        free(workers);
+        free(helpers);
+        return;
+    }
+    pool.rounds = rounds;
+    pool.nextGame = 0;
+    pool.seed = seed;
+    ttt_mutexInit(&pool.lock);
+
+    for (int p = 0; p < pairCount; p++) {
+        for (int s = 0; s < TOURNAMENT_SIZES; s++) {
+            for (int colour = 0; colour < 2; colour++) {
+                TournamentSeries *series = &pool.series[(p * TOURNAMENT_SIZES + s) * 2 + colour];
+                series->x = pairs[p][colour];
+                series->o = pairs[p][1 - colour];
+                series->boardSize = sizes[s];
+            }
+        }
+    }
 
-    for (int i = 0; i < 4; i++) {
-        float winRate = (stats[i].matches > 0) ?
-                       ((float)stats[i].wins / stats[i].matches * 100) : 0.0;
-        printf("%-10s %-8d %-6d %-8d %-7d %.1f%%\n",
-               stats[i].name, stats[i].matches,
-               stats[i].wins, stats[i].losses, stats[i].draws, winRate);
+    // One worker per shard after the interactive game's; the calling
+    // thread is the first of them
+    int threads = statShardCount - 1;
+    if (threads > pool.seriesCount * rounds) threads = pool.seriesCount * rounds;
+
+    for (int t = 0; t < threads; t++) {
+        workers[t].pool = &pool;
+        workers[t].shard = &statShards[1 + t];
     }
+    for (int t = 1; t < threads; t++) {
+        if (ttt_threadStart(&helpers[started], tournamentWorker, &workers[t])) started++;
+    }
+    tournamentWorker(&workers[0]);
+    for (int t = 0; t < started; t++) {
+        ttt_threadJoin(helpers[t]);
+    }
+    ttt_mutexDestroy(&pool.lock);
+
+    for (int i = 0; i < pool.seriesCount; i++) {
+        TournamentSeries *series = &pool.series[i];
+        EngineResult *x = &results[series->x];
+        EngineResult *o = &results[series->o];
+
+        x->games += series->result.games;
+        x->wins += series->result.wins;
+        x->losses += series->result.losses;
+        x->draws += series->result.draws;
+        o->games += series->result.games;
+        o->wins += series->result.losses;
+        o->losses += series->result.wins;
+        o->draws += series->result.draws;
+
+        // Each series goes into the match history once, with its colours
+        const char *seriesWinner = (series->result.wins > series->result.losses) ? ttt_botEngines[series->x].name :
+                                   (series->result.losses > series->result.wins) ? ttt_botEngines[series->o].name : "Draw";
+        printf("%-6s %-10s (X) vs %-10s (O)  +%d -%d =%d\n", boardSizeName(series->boardSize),
+               ttt_botEngines[series->x].name, ttt_botEngines[series->o].name,
+               series->result.wins, series->result.losses, series->result.draws);
+        saveMatchResult(ttt_botEngines[series->x].name, ttt_botEngines[series->o].name, seriesWinner, 3, series->boardSize);
+        commitMatches(0);
+    }
+
+    free(pool.series);
+    free(workers);
+    free(helpers);
 }
 
-void updateStats(PlayerStats stats[4], int winner, int mode) {
-    if (mode == 1) { // PVP mode
-        stats[0].matches++; // Host
-        stats[1].matches++; // Guest
+// Claims one game at a time until the round runs out
+void *tournamentWorker(void *arg) {
+    TournamentWorker *worker = (TournamentWorker *)arg;
+    TournamentPool *pool = worker->pool;
 
-        if (winner == 1) {
-            stats[0].wins++;
-            stats[1].losses++;
-        } else if (winner == 2) {
-            stats[1].wins++;
-            stats[0].losses++;
-        } else {
-            stats[0].draws++;
-            stats[1].draws++;
-        }
-    } else if (mode == 2) { // PVE mode
-        stats[2].matches++; // Player
-        stats[3].matches++; // Bot
+    for (;;) {
+        ttt_mutexLock(&pool->lock);
+        int game = pool->nextGame++;
+        ttt_mutexUnlock(&pool->lock);
 
+        if (game >= pool->seriesCount * pool->rounds) break;
+
+        TournamentSeries *series = &pool->series[game / pool->rounds];
+        int winner = playBotGame(&ttt_botEngines[series->x], &ttt_botEngines[series->o], series->boardSize,
+                                 pool->seed + (uint64_t)game);
+        updateEngineStats(worker->shard, series->x, series->o, winner);
+
+        ttt_mutexLock(&pool->lock);
+        series->result.games++;
         if (winner == 1) {
-            stats[2].wins++;
-            stats[3].losses++;
+            series->result.wins++;
         } else if (winner == 2) {
-            stats[3].wins++;
-            stats[2].losses++;
+            series->result.losses++;
         } else {
-            stats[2].draws++;
-            stats[3].draws++;
+            series->result.draws++;
         }
+        ttt_mutexUnlock(&pool->lock);
     }
+
+    return NULL;
 }
 
-// -------------------------
-// Match History Functions
-// -------------------------
-void saveMatchResult(const char *p1, const char *p2, const char *winner, int mode, int boardSize) {
-    // Read existing file content
-    FILE *existingFile = fopen("game_data.txt", "r");
-    FILE *tempFile = fopen("temp_complete_file.txt", "a");
+// Walks the standings from the top and pairs each engine with the
+// highest-placed engine it has not met yet (a rematch only when nobody else
+// is left); with an odd field the last engine sits the round out
+int swissPairings(EngineResult results[MAX_ENGINES], int met[MAX_ENGINES][MAX_ENGINES], int pairs[][2]) {
+    int order[MAX_ENGINES];
+    int paired[MAX_ENGINES] = {0};
+    int count = 0;
 
-    if (tempFile == NULL) {
-        printf("Error: Unable to save match history!\n");
-        return;
+    // Insertion sort on points (2 per win, 1 per draw); ties keep engine order
+    for (int i = 0; i < ttt_numBotEngines; i++) {
+        int points = 2 * results[i].wins + results[i].draws;
+        int j = i - 1;
+
+        while (j >= 0 && 2 * results[order[j]].wins + results[order[j]].draws < points) {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = i;
     }
 
-    char timestamp[100];
-    getCurrentTimestamp(timestamp);
+    for (int i = 0; i < ttt_numBotEngines; i++) {
+        int a = order[i];
+        int b = -1;
 
-    // If file exists, copy everything up to and including match history header
-    if (existingFile != NULL) {
-        char line[200];
-        while (fgets(line, sizeof(line), existingFile) != NULL) {
-            fprintf(tempFile, "%s", line);
-            // Stop after the match history header to append new match
-            if (strstr(line, "=== MATCH HISTORY ===") != NULL) {
-                break;
-            }
+        if (paired[a]) continue;
+        for (int j = i + 1; j < ttt_numBotEngines && b == -1; j++) {
+            if (!paired[order[j]] && !met[a][order[j]]) b = order[j];
         }
-
-        // Copy existing match history entries
-        while (fgets(line, sizeof(line), existingFile) != NULL) {
-            fprintf(tempFile, "%s", line);
+        for (int j = i + 1; j < ttt_numBotEngines && b == -1; j++) {
+            if (!paired[order[j]]) b = order[j];
         }
 
-        fclose(existingFile);
-    } else {
-        // If file does not exist, create basic structure
-        fprintf(tempFile, "=== GAME STATISTICS ===\n");
-        fprintf(tempFile, "%-10s %-8s %-6s %-8s %-7s %-8s\n", "Player", "Matches", "Wins", "Losses", "Draws", "Win Rate");
-        fprintf(tempFile, "--------------------------------------------------------\n");
-        fprintf(tempFile, "%-10s %-8d %-6d %-8d %-7d %.1f%%\n", "Host", 0, 0, 0, 0, 0.0);
-        fprintf(tempFile, "%-10s %-8d %-6d %-8d %-7d %.1f%%\n", "Guest", 0, 0, 0, 0, 0.0);
-        fprintf(tempFile, "%-10s %-8d %-6d %-8d %-7d %.1f%%\n", "Player", 0, 0, 0, 0, 0.0);
-        fprintf(tempFile, "%-10s %-8d %-6d %-8d %-7d %.1f%%\n", "Bot", 0, 0, 0, 0, 0.0);
-        fprintf(tempFile, "\n=== MATCH HISTORY ===\n");
+        paired[a] = 1;
+        if (b == -1) {
+            printf("%s has a bye\n", ttt_botEngines[a].name);
+            continue;
+        }
+        paired[b] = 1;
+        met[a][b] = 1;
+        met[b][a] = 1;
+        pairs[count][0] = a;
+        pairs[count][1] = b;
+        count++;
     }
 
-    // Add new match entry
-    fprintf(tempFile, "Date & Time: %s", timestamp);
-    fprintf(tempFile, "Board Size: %dx%d\n", boardSize, boardSize);
-    fprintf(tempFile, "Game Mode: %s\n", (mode == 1) ? "PVP" : "PVE");
-    fprintf(tempFile, "Player 1: %s (X)\n", p1);
-    fprintf(tempFile, "Player 2: %s (O)\n", p2);
-    fprintf(tempFile, "Winner: %s\n", winner);
-    fprintf(tempFile, "=====================================\n");
+    return count;
+}
 
-    fclose(tempFile);
+void benchmarkWinCheck() {
+    const int positions = 1024;
+    const int passes = 2000;
+    int sizes[3] = {3, 4, QUBIC_BOARD};
 
-    // Replace original file
-    remove("game_data.txt");
-    rename("temp_complete_file.txt", "game_data.txt");
-}
+    printf("\n=== WIN CHECK BENCHMARK ===\n");
+    printf("%-6s %-14s %-14s %-8s\n", "Board", "Scan (ns)", "Masks (ns)", "Speedup");
+    printf("----------------------------------------------\n");
+
+    for (int s = 0; s < 3; s++) {
+        Game *games = (Game *)malloc(positions * sizeof(Game));
+        volatile int sink = 0;
+
+        if (games == NULL) {
+            printf("Error: Out of memory!\n");
+            return;
+        }
+
+        // Random mid-game positions with both symbols on the board
+        for (int g = 0; g < positions; g++) {
+            char symbol = 'X';
+            initializeBoard(&games[g], sizes[s]);
+            int moves = rand() % games[g].cells;
+            for (int m = 0; m < moves; m++) {
+                makeMove(&games[g], randomMove(&games[g]), symbol);
+                symbol = (symbol == 'X') ? 'O' : 'X';
+            }
+        }
+
+        clock_t start = clock();
+        for (int p = 0; p < passes; p++) {
+            for (int g = 0; g < positions; g++) {
+                sink += checkWinnerScan(&games[g], 'X');
+            }
+        }
+        double scanTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        start = clock();
+        for (int p = 0; p < passes; p++) {
+            for (int g = 0; g < positions; g++) {
+                sink += checkWinner(&games[g], 'X');
+            }
+        }
+        double maskTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        double calls = (double)positions * passes;
+        printf("%-6s %-14.2f %-14.2f %.1fx\n", boardSizeName(sizes[s]),
+               scanTime * 1e9 / calls, maskTime * 1e9 / calls,
+               (maskTime > 0) ? scanTime / maskTime : 0.0);
+
+        for (int g = 0; g < positions; g++) {
+            freeBoard(&games[g]);
+        }
+        free(games);
+    }
+}
+
+// Random playouts from the empty board: one Game at a time through
+// makeMove/checkWinner against the struct-of-arrays batch
+void benchmarkRollouts() {
+    const int rollouts = 200000;
+    int sizes[3] = {3, 4, QUBIC_BOARD};
+
+    printf("\n=== ROLLOUT BENCHMARK (%s) ===\n", rolloutKernelName());
+    printf("%-6s %-16s %-16s %-8s\n", "Board", "Single (/sec)", "Batch (/sec)", "Speedup");
+    printf("--------------------------------------------------\n");
+
+    for (int s = 0; s < 3; s++) {
+        Game game;
+        int single[3] = {0, 0, 0};
+        int batch[3];
+
+        initializeBoard(&game, sizes[s]);
+
+        clock_t start = clock();
+        for (int r = 0; r < rollouts; r++) {
+            char symbol = 'X';
+            int winner = 0;
+            while (!isDraw(&game)) {
+                makeMove(&game, randomMove(&game), symbol);
+                if (checkWinner(&game, symbol)) {
+                    winner = (symbol == 'X') ? 1 : 2;
+                    break;
+                }
+                symbol = (symbol == 'X') ? 'O' : 'X';
+            }
+            single[winner]++;
+            undoMoves(&game, game.historyTop);
+        }
+        double singleTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        start = clock();
+        runRollouts(&game, rollouts, (uint64_t)time(NULL), batch);
+        double batchTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        printf("%-6s %-16.0f %-16.0f %.1fx\n", boardSizeName(sizes[s]),
+               (singleTime > 0) ? rollouts / singleTime : 0.0,
+               (batchTime > 0) ? rollouts / batchTime : 0.0,
+               (batchTime > 0) ? singleTime / batchTime : 0.0);
+        printf("       X/O/draw: %d/%d/%d vs %d/%d/%d\n",
+               single[1], single[2], single[0], batch[1], batch[2], batch[0]);
+
+        freeBoard(&game);
+    }
+}
+
+// Trains the learned evaluator by self-play, saves the weights and checks
+// the Learned engine against Random on the same board
+void trainLearnedEngine() {
+    int boardSize;
+    int games;
+    int matches = 20;
+    EngineResult result = {0, 0, 0, 0};
+    BotEngine *learned = findEngine(ENGINE_LEARNED);
+    BotEngine *random = findEngine(ENGINE_RANDOM);
+
+    printf("\n=== TRAIN LEARNED EVALUATOR ===\n");
+    printf("Board (3 = 3x3, 4 = 4x4, 5 = 4x4x4, 6 = Gomoku): ");
+    scanf("%d", &boardSize);
+    clearInputBuffer();
+    if (boardSize < 3 || boardSize > GOMOKU_BOARD) {
+        printf("Invalid board!\n");
+        return;
+    }
+
+    printf("Self-play games: ");
+    scanf("%d", &games);
+    clearInputBuffer();
+    if (games < 1) {
+        printf("Invalid number of games!\n");
+        return;
+    }
+
+    // Train in slices so long runs show progress
+    int slice = (games < 10) ? 1 : games / 10;
+    clock_t start = clock();
+    for (int done = 0; done < games; ) {
+        int chunk = (games - done < slice) ? games - done : slice;
+        trainEvaluator(boardSize, chunk);
+        done += chunk;
+        printf("\r%d / %d games", done, games);
+        fflush(stdout);
+    }
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("\nTrained in %.1f s (%.0f games/sec)\n", seconds, (seconds > 0) ? games / seconds : 0.0);
+
+    if (saveEvalWeights(EVAL_WEIGHTS_FILE)) {
+        printf("Weights saved to %s\n", EVAL_WEIGHTS_FILE);
+    } else {
+        printf("Error: Could not save weights!\n");
+    }
+
+    // Half the games with each colour
+    for (int g = 0; g < matches; g++) {
+        int learnedFirst = (g % 2 == 0);
+        uint64_t seed = (uint64_t)rand();
+        int winner = learnedFirst ? playBotGame(learned, random, boardSize, seed) : playBotGame(random, learned, boardSize, seed);
+
+        result.games++;
+        if (winner == 0) {
+            result.draws++;
+        } else if ((winner == 1) == learnedFirst) {
+            result.wins++;
+        } else {
+            result.losses++;
+        }
+    }
+    printf("%s vs %s on %s: %d wins, %d losses, %d draws\n", learned->name, random->name,
+           boardSizeName(boardSize), result.wins, result.losses, result.draws);
+}
+
+typedef struct {
+    StatShard *shard;     // Padded shard, or NULL to use seats
+    SeatCounters *seats;
+    long updates;
+} StatBenchJob;
+
+// Called through volatile pointers so the compiler cannot fold the loops
+void (*volatile statBenchUpdate)(StatShard *shard, int winner, int mode) = updateStats;
+void (*volatile statBenchSeats)(SeatCounters *seats, int winner, int mode) = updateSeatCounters;
+
+// Same bookkeeping as updateStats, with the seats of the game's mode
+// packed together
+void updateSeatCounters(SeatCounters *seats, int winner, int mode) {
+    if (mode != 1 && mode != 2) return;
+
+    seats->matches[0]++;
+    seats->matches[1]++;
+
+    if (winner == 1) {
+        seats->wins[0]++;
+        seats->losses[1]++;
+    } else if (winner == 2) {
+        seats->wins[1]++;
+        seats->losses[0]++;
+    } else {
+        seats->draws[0]++;
+        seats->draws[1]++;
+    }
+}
+
+void *statBenchWorker(void *arg) {
+    StatBenchJob *job = (StatBenchJob *)arg;
+
+    if (job->shard != NULL) {
+        for (long i = 0; i < job->updates; i++) {
+            statBenchUpdate(job->shard, (int)(i % 3), 2);
+        }
+    } else {
+        for (long i = 0; i < job->updates; i++) {
+            statBenchSeats(job->seats, (int)(i % 3), 2);
+        }
+    }
+    return NULL;
+}
+
+// Wall-clock seconds for the given threads to record their results, each
+// into its own counters: a padded shard, or packed seats next to the other
+// threads'. started receives the number of threads that actually ran; only
+// those are joined.
+double runStatBench(int threads, int padded, StatShard *shards, SeatCounters *seats, int *started) {
+    Thread ids[STAT_BENCH_THREADS];
+    StatBenchJob jobs[STAT_BENCH_THREADS];
+
+    memset(shards, 0, STAT_BENCH_THREADS * sizeof(StatShard));
+    memset(seats, 0, STAT_BENCH_THREADS * sizeof(SeatCounters));
+    *started = 0;
+
+    double start = ttt_wallSeconds();
+    for (int t = 0; t < threads; t++) {
+        jobs[t].shard = padded ? &shards[t] : NULL;
+        jobs[t].seats = &seats[t];
+        jobs[t].updates = STAT_BENCH_UPDATES / threads;
+        if (ttt_threadStart(&ids[*started], statBenchWorker, &jobs[t])) (*started)++;
+    }
+    for (int t = 0; t < *started; t++) {
+        ttt_threadJoin(ids[t]);
+    }
+
+    return ttt_wallSeconds() - start;
+}
+
+// Total results recorded per second with 1..16 threads, each with counters
+// of its own. Packed counters falsely share cache lines between threads;
+// the padded shards should scale with the thread count instead.
+void benchmarkStatShards() {
+    StatShard *shards = (StatShard *)calloc(STAT_BENCH_THREADS, sizeof(StatShard));
+    SeatCounters *seats = (SeatCounters *)calloc(STAT_BENCH_THREADS, sizeof(SeatCounters));
+
+    if (shards == NULL || seats == NULL) {
+        printf("Error: Out of memory!\n");
+        free(shards);
+        free(seats);
+        return;
+    }
+
+    printf("\n=== STATS CONTENTION BENCHMARK ===\n");
+    printf("%-8s %-18s %-18s %-8s\n", "Threads", "Packed (M/sec)", "Padded (M/sec)", "Speedup");
+    printf("------------------------------------------------------\n");
+
+    for (int threads = 1; threads <= STAT_BENCH_THREADS; threads *= 2) {
+        long expected = (long)(STAT_BENCH_UPDATES / threads) * threads;
+
+        int packedStarted, paddedStarted;
+        double packedTime = runStatBench(threads, 0, shards, seats, &packedStarted);
+        double paddedTime = runStatBench(threads, 1, shards, seats, &paddedStarted);
+
+        if (packedStarted < threads || paddedStarted < threads) {
+            printf("Error: Only %d of %d threads could be started!\n",
+                   (packedStarted < paddedStarted) ? packedStarted : paddedStarted, threads);
+            break;
+        }
+
+        printf("%-8d %-18.1f %-18.1f %.2fx\n", threads,
+               (packedTime > 0) ? expected / packedTime / 1e6 : 0.0,
+               (paddedTime > 0) ? expected / paddedTime / 1e6 : 0.0,
+               (paddedTime > 0) ? packedTime / paddedTime : 0.0);
+    }
+
+    free(shards);
+    free(seats);
+}
+
+// -------------------------
+// State-Space Enumerator Functions
+// -------------------------
+// Counts every reachable position for an NxN board and K-in-a-row rule.
+// Positions are expanded one ply at a time by one thread per core; each
+// ply's children are canonicalized under the 8 board symmetries and
+// collected in a shared lock-free hash set, which is spilled as a sorted run
+// whenever it fills. The runs are merged, so duplicates vanish without
+// holding the whole state space in memory.
+void enumerateStates() {
+    int size, winLength;
+    int symmetry[8][ENUM_MAX_SIZE * ENUM_MAX_SIZE];
+    Game game;
+
+    printf("\n=== STATE-SPACE ENUMERATOR ===\n");
+    printf("Board size (3-%d): ", ENUM_MAX_SIZE);
+    scanf("%d", &size);
+    clearInputBuffer();
+    if (size < 3 || size > ENUM_MAX_SIZE) {
+        printf("Invalid size!\n");
+        return;
+    }
+    printf("Stones in a row to win (3-%d): ", size);
+    scanf("%d", &winLength);
+    clearInputBuffer();
+    if (winLength < 3 || winLength > size) {
+        printf("Invalid rule!\n");
+        return;
+    }
+
+    initializeBoardRule(&game, size, winLength);
+    int cells = game.cells;
+
+    // Cell permutations for the rotations and reflections of the square
+    for (int t = 0; t < 8; t++) {
+        for (int row = 0; row < size; row++) {
+            for (int col = 0; col < size; col++) {
+                int r = row, c = col;
+                if (t & 4) c = size - 1 - c;         // Mirror
+                for (int turn = 0; turn < (t & 3); turn++) {
+                    int old = r;                     // Rotate 90 degrees
+                    r = c;
+                    c = size - 1 - old;
+                }
+                symmetry[t][row * size + col] = r * size + c;
+            }
+        }
+    }
+
+    uint64_t *table = (uint64_t *)calloc(ENUM_TABLE_SLOTS, sizeof(uint64_t));
+    uint64_t *parents = (uint64_t *)malloc(ENUM_PARENT_BATCH * sizeof(uint64_t));
+    EnumRun *runs = (EnumRun *)malloc(ENUM_MAX_RUNS * sizeof(EnumRun));
+    FILE *frontier = tmpfile();
+    if (table == NULL || parents == NULL || runs == NULL || frontier == NULL) {
+        printf("Error: Unable to allocate enumerator storage!\n");
+        free(table);
+        free(parents);
+        free(runs);
+        if (frontier != NULL) fclose(frontier);
+        freeBoard(&game);
+        return;
+    }
+
+    uint64_t empty = 0;
+    uint64_t frontierCount = 1;
+    uint64_t totals[4] = {0, 0, 0, 1}; // X wins, O wins, draws, ongoing
+    int failed = 0;
+    fwrite(&empty, sizeof(empty), 1, frontier);
+
+    printf("\n%-5s %-14s %-12s %-12s %-10s %-14s\n", "Ply", "Positions", "X wins", "O wins", "Draws", "Ongoing");
+    printf("----------------------------------------------------------------------\n");
+    printf("%-5d %-14d %-12d %-12d %-10d %-14d\n", 0, 1, 0, 0, 0, 1);
+
+    double start = ttt_wallSeconds();
+    uint64_t generated = 0;
+    int threads = ttt_cpuCount();
+    EnumBatch batch;
+
+    batch.table = table;
+    batch.parents = parents;
+    batch.cells = cells;
+    batch.symmetry = symmetry;
+    ttt_mutexInit(&batch.lock);
+
+    for (int ply = 0; ply < cells && frontierCount > 0 && !failed; ply++) {
+        int children = cells - ply; // Empty cells in every frontier position
+        uint64_t slots = ENUM_TABLE_MIN;
+        uint64_t held = 0;
+        int runCount = 0;
+
+        // Size the set for this ply's successors (kept at most half full),
+        // so small plies do not scan and clear the whole table
+        while (slots < ENUM_TABLE_SLOTS && slots < 2 * frontierCount * children) slots *= 2;
+        batch.mask = slots - 1;
+
+        // Expand the frontier in batches small enough that the set can
+        // never pass half full, spilling it whenever it fills up
+        batch.shift = (ply % 2 == 0) ? 0 : 32; // X moves on even plies
+        rewind(frontier);
+        while (!failed) {
+            uint64_t room = (slots / 2 - held) / children;
+
+            if (room < ENUM_CLAIM && held > 0) {
+                failed = !spillTable(table, slots, runs, &runCount);
+                held = 0;
+                continue;
+            }
+            if (room > ENUM_PARENT_BATCH) room = ENUM_PARENT_BATCH;
+
+            batch.parentCount = (int)fread(parents, sizeof(uint64_t), room, frontier);
+            if (batch.parentCount == 0) break;
+            held += expandBatch(&batch, threads);
+            generated += batch.generated;
+        }
+        if (!failed && held > 0) {
+            failed = !spillTable(table, slots, runs, &runCount);
+        }
+        fclose(frontier);
+
+        frontier = tmpfile();
+        if (failed || frontier == NULL) {
+            for (int r = 0; r < runCount; r++) {
+                fclose(runs[r].file);
+            }
+            failed = 1;
+            break;
+        }
+
+        // Merge the runs, classify each unique position and keep the ongoing ones
+        uint64_t counts[4] = {0, 0, 0, 0};
+        uint64_t previous = 0;
+        uint64_t key;
+        int havePrevious = 0;
+        rewindRuns(runs, runCount);
+
+        while (nextMergedKey(runs, runCount, &key)) {
+            if (havePrevious && key == previous) continue;
+            previous = key;
+            havePrevious = 1;
+
+            game.bits[0] = key & 0xFFFFFFFFULL;
+            game.bits[1] = key >> 32;
+            int outcome = checkWinner(&game, 'X') ? 0 :
+                          checkWinner(&game, 'O') ? 1 :
+                          (ply + 1 == cells) ? 2 : 3;
+            counts[outcome]++;
+            if (outcome == 3) fwrite(&key, sizeof(key), 1, frontier);
+        }
+
+        for (int r = 0; r < runCount; r++) {
+            fclose(runs[r].file);
+        }
+
+        frontierCount = counts[3];
+        for (int i = 0; i < 4; i++) totals[i] += counts[i];
+        printf("%-5d %-14llu %-12llu %-12llu %-10llu %-14llu\n", ply + 1,
+               (unsigned long long)(counts[0] + counts[1] + counts[2] + counts[3]),
+               (unsigned long long)counts[0], (unsigned long long)counts[1],
+               (unsigned long long)counts[2], (unsigned long long)counts[3]);
+    }
+
+    double seconds = ttt_wallSeconds() - start;
+    ttt_mutexDestroy(&batch.lock);
+
+    if (failed) {
+        printf("Error: Enumeration stopped (out of temporary storage)!\n");
+    } else {
+        uint64_t total = totals[0] + totals[1] + totals[2] + totals[3];
+        printf("----------------------------------------------------------------------\n");
+        printf("%-5s %-14llu %-12llu %-12llu %-10llu %-14llu\n", "All",
+               (unsigned long long)total, (unsigned long long)totals[0],
+               (unsigned long long)totals[1], (unsigned long long)totals[2],
+               (unsigned long long)totals[3]);
+        printf("\nUnique positions up to symmetry for %dx%d, %d in a row.\n", size, size, winLength);
+        printf("Generated %llu successors in %.2f s (%.0f states/sec, %d threads)\n", (unsigned long long)generated,
+               seconds, (seconds > 0) ? generated / seconds : 0.0, threads);
+    }
+
+    if (frontier != NULL) fclose(frontier);
+    free(table);
+    free(parents);
+    free(runs);
+    freeBoard(&game);
+}
+
+// Smallest packed key over the 8 symmetries of the board
+uint64_t canonicalKey(uint64_t key, int cells, int symmetry[8][ENUM_MAX_SIZE * ENUM_MAX_SIZE]) {
+    uint64_t best = key;
+
+    for (int t = 1; t < 8; t++) {
+        uint64_t mapped = 0;
+        for (int cell = 0; cell < cells; cell++) {
+            uint64_t target = (uint64_t)1 << symmetry[t][cell];
+            if (key & ((uint64_t)1 << cell)) mapped |= target;
+            if (key & ((uint64_t)1 << (cell + 32))) mapped |= target << 32;
+        }
+        if (mapped < best) best = mapped;
+    }
+
+    return best;
+}
+
+int compareKeys(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Expands one batch of parents into the shared set on the calling thread
+// and up to threads - 1 helpers; returns the number of new keys
+uint64_t expandBatch(EnumBatch *batch, int threads) {
+    Thread helpers[ENUM_MAX_THREADS];
+    int started = 0;
+
+    batch->nextParent = 0;
+    batch->inserted = 0;
+    batch->generated = 0;
+
+    if (threads > ENUM_MAX_THREADS) threads = ENUM_MAX_THREADS;
+    if (threads > (batch->parentCount + ENUM_CLAIM - 1) / ENUM_CLAIM) {
+        threads = (batch->parentCount + ENUM_CLAIM - 1) / ENUM_CLAIM;
+    }
+
+    for (int t = 1; t < threads; t++) {
+        if (ttt_threadStart(&helpers[started], expandWorker, batch)) started++;
+    }
+    expandWorker(batch);
+    for (int t = 0; t < started; t++) {
+        ttt_threadJoin(helpers[t]);
+    }
+
+    return batch->inserted;
+}
+
+void *expandWorker(void *arg) {
+    EnumBatch *batch = (EnumBatch *)arg;
+    uint64_t inserted = 0;
+    uint64_t generated = 0;
+
+    for (;;) {
+        ttt_mutexLock(&batch->lock);
+        int first = batch->nextParent;
+        batch->nextParent += ENUM_CLAIM;
+        ttt_mutexUnlock(&batch->lock);
+
+        if (first >= batch->parentCount) break;
+        int last = (first + ENUM_CLAIM < batch->parentCount) ? first + ENUM_CLAIM : batch->parentCount;
+
+        for (int i = first; i < last; i++) {
+            uint64_t parent = batch->parents[i];
+            uint64_t occupied = (parent | (parent >> 32)) & 0xFFFFFFFFULL;
+
+            for (int cell = 0; cell < batch->cells; cell++) {
+                if (occupied & ((uint64_t)1 << cell)) continue;
+                uint64_t child = parent | ((uint64_t)1 << (cell + batch->shift));
+                inserted += insertKey(batch->table, batch->mask, canonicalKey(child, batch->cells, batch->symmetry));
+                generated++;
+            }
+        }
+    }
+
+    ttt_mutexLock(&batch->lock);
+    batch->inserted += inserted;
+    batch->generated += generated;
+    ttt_mutexUnlock(&batch->lock);
+    return NULL;
+}
+
+// Lock-free insert with linear probing: a free slot is claimed with a
+// compare-and-swap, and a thread that loses the race re-reads the slot.
+// Returns 1 if the key was new.
+int insertKey(volatile uint64_t *table, uint64_t mask, uint64_t key) {
+    uint64_t slot = key ^ (key >> 33);
+
+    slot *= 0xFF51AFD7ED558CCDULL;
+    slot ^= slot >> 33;
+    for (slot &= mask;; slot = (slot + 1) & mask) {
+        uint64_t seen = ttt_atomicLoad64(&table[slot]);
+
+        if (seen == key) return 0;
+        if (seen == 0) {
+            if (ttt_atomicCompareSwap64(&table[slot], 0, key)) return 1;
+            if (ttt_atomicLoad64(&table[slot]) == key) return 0;
+        }
+    }
+}
+
+// Packs the set's keys to the front, writes them out as a sorted run and
+// empties the set. Once ENUM_MAX_RUNS runs exist they are merged into one
+// first, so any number of runs fits in a ply.
+int spillTable(uint64_t *table, uint64_t slots, EnumRun *runs, int *runCount) {
+    int count = 0;
+
+    for (uint64_t i = 0; i < slots; i++) {
+        if (table[i] != 0) table[count++] = table[i];
+    }
+
+    if (*runCount == ENUM_MAX_RUNS && !compactRuns(runs, runCount)) return 0;
+    int stored = spillRun(table, count, runs, runCount);
+
+    memset(table, 0, slots * sizeof(uint64_t));
+    return stored;
+}
+
+// Sorts the buffer, drops duplicates and writes it to a new temporary run
+int spillRun(uint64_t *buffer, int count, EnumRun *runs, int *runCount) {
+    int unique = 0;
+
+    if (*runCount == ENUM_MAX_RUNS) return 0;
+
+    qsort(buffer, count, sizeof(uint64_t), compareKeys);
+    for (int i = 0; i < count; i++) {
+        if (unique == 0 || buffer[i] != buffer[unique - 1]) {
+            buffer[unique++] = buffer[i];
+        }
+    }
+
+    FILE *file = tmpfile();
+    if (file == NULL) return 0;
+    if (fwrite(buffer, sizeof(uint64_t), unique, file) != (size_t)unique) {
+        fclose(file);
+        return 0;
+    }
+
+    runs[*runCount].file = file;
+    (*runCount)++;
+    return 1;
+}
+
+// Refills a run's read buffer; returns 0 once the run is exhausted
+int refillRun(EnumRun *run) {
+    run->len = (int)fread(run->keys, sizeof(uint64_t), ENUM_READ_CHUNK, run->file);
+    run->pos = 0;
+    return run->len > 0;
+}
+
+void rewindRuns(EnumRun *runs, int runCount) {
+    for (int r = 0; r < runCount; r++) {
+        runs[r].pos = runs[r].len = 0;
+        rewind(runs[r].file);
+    }
+}
+
+// Takes the smallest next key across the runs (duplicates included);
+// returns 0 once every run is exhausted
+int nextMergedKey(EnumRun *runs, int runCount, uint64_t *key) {
+    int best = -1;
+
+    for (int r = 0; r < runCount; r++) {
+        if (runs[r].pos == runs[r].len && !refillRun(&runs[r])) continue;
+        uint64_t candidate = runs[r].keys[runs[r].pos];
+        if (best == -1 || candidate < *key) {
+            best = r;
+            *key = candidate;
+        }
+    }
+    if (best == -1) return 0;
+
+    runs[best].pos++;
+    return 1;
+}
+
+// Merge pass: replaces every run with a single de-duplicated run
+int compactRuns(EnumRun *runs, int *runCount) {
+    FILE *merged = tmpfile();
+    uint64_t key;
+    uint64_t previous = 0;
+    int havePrevious = 0;
+    int written = 1;
+
+    if (merged == NULL) return 0;
+
+    rewindRuns(runs, *runCount);
+    while (written && nextMergedKey(runs, *runCount, &key)) {
+        if (havePrevious && key == previous) continue;
+        previous = key;
+        havePrevious = 1;
+        written = (fwrite(&key, sizeof(key), 1, merged) == 1);
+    }
+
+    for (int r = 0; r < *runCount; r++) {
+        fclose(runs[r].file);
+    }
+    runs[0].file = merged;
+    *runCount = 1;
+
+    return written;
+}
+
+// -------------------------
+// Statistics Functions
+// -------------------------
+void loadStats(PlayerStats stats[STAT_PLAYERS]) {
+    FILE *file = fopen("game_data.txt", "r");
+
+    for (int i = 0; i < STAT_PLAYERS; i++) {
+        stats[i].matches = 0;
+        stats[i].wins = 0;
+        stats[i].losses = 0;
+        stats[i].draws = 0;
+    }
+
+    if (file == NULL) {
+        return;
+    }
+
+    char line[200];
+    int lineCount = 0;
+    PlayerStats row;
+
+    // Rows are matched by name, so files from before the engine rows load too;
+    // the table ends at the blank line before the match history
+    while (fgets(line, sizeof(line), file) != NULL) {
+        lineCount++;
+        if (lineCount <= 3) continue;
+
+        if (sscanf(line, "%49s %d %d %d %d", row.name, &row.matches,
+                   &row.wins, &row.losses, &row.draws) != 5) break;
+
+        for (int i = 0; i < STAT_PLAYERS; i++) {
+            if (strcmp(stats[i].name, row.name) == 0) {
+                stats[i].matches = row.matches;
+                stats[i].wins = row.wins;
+                stats[i].losses = row.losses;
+                stats[i].draws = row.draws;
+                break;
+            }
+        }
+    }
+
+    fclose(file);
+}
+
+// Group commit: statistics, the existing history and a batch of matches
+// are written in one rewrite of game_data.txt (on the writer thread).
+// Returns the PERSIST_* failures, 0 if everything was written.
+int saveStats(PlayerStats stats[STAT_PLAYERS], MatchRecord *matches, int count) {
+    FILE *existingFile = fopen("game_data.txt", "r");
+    FILE *file = fopen("temp_complete_file.txt", "w");
+
+    if (file == NULL) {
+        if (existingFile != NULL) fclose(existingFile);
+        return PERSIST_STATS_FAILED;
+    }
+
+    // Write Game Statistics
+    fprintf(file, "=== GAME STATISTICS ===\n");
+    fprintf(file, "%-10s %-8s %-6s %-8s %-7s %-8s\n", "Player", "Matches", "Wins", "Losses", "Draws", "Win Rate");
+    fprintf(file, "--------------------------------------------------------\n");
+
+    for (int i = 0; i < STAT_ENGINE_BASE + ttt_numBotEngines; i++) {
+        float winRate = (stats[i].matches > 0) ?
+                       ((float)stats[i].wins / stats[i].matches * 100) : 0.0;
+        fprintf(file, "%-10s %-8d %-6d %-8d %-7d %.1f%%\n",
+                stats[i].name, stats[i].matches,
+                stats[i].wins, stats[i].losses, stats[i].draws, winRate);
+    }
+
+    fprintf(file, "\n");
+
+    // Copy the existing match history section
+    int foundHistorySection = 0;
+    if (existingFile != NULL) {
+        char line[200];
+        while (fgets(line, sizeof(line), existingFile) != NULL) {
+            if (strstr(line, "=== MATCH HISTORY ===") != NULL) {
+                foundHistorySection = 1;
+            }
+            if (foundHistorySection) {
+                fprintf(file, "%s", line);
+            }
+        }
+        fclose(existingFile);
+    }
+    if (!foundHistorySection) {
+        // If no existing history, create the section
+        fprintf(file, "=== MATCH HISTORY ===\n");
+    }
+
+    // Append the matches finished since the last commit
+    for (int i = 0; i < count; i++) {
+        writeMatchRecord(file, &matches[i]);
+    }
+
+    // The one sync of the group commit: the whole batch reaches the disk
+    // before the rename makes it the live file
+    if (!closeSynced(file) || !replaceFile("temp_complete_file.txt", "game_data.txt")) {
+        remove("temp_complete_file.txt");
+        return PERSIST_STATS_FAILED;
+    }
+
+    return rotateMatchHistory();
+}
+
+void displayStats(PlayerStats stats[STAT_PLAYERS]) {
+    mergeStats(stats);
+
+    printf("\n=== GAME STATISTICS ===\n");
+    printf("%-10s %-8s %-6s %-8s %-7s %-8s\n", "Player", "Matches", "Wins", "Losses", "Draws", "Win Rate");
+    printf("--------------------------------------------------------\n");
+
+    // Engines only show up once they have played a tournament game
+    for (int i = 0; i < STAT_ENGINE_BASE + ttt_numBotEngines; i++) {
+        if (i >= STAT_ENGINE_BASE && stats[i].matches == 0) continue;
+
+        float winRate = (stats[i].matches > 0) ?
+                       ((float)stats[i].wins / stats[i].matches * 100) : 0.0;
+        printf("%-10s %-8d %-6d %-8d %-7d %.1f%%\n",
+               stats[i].name, stats[i].matches,
+               stats[i].wins, stats[i].losses, stats[i].draws, winRate);
+    }
+}
+
+// Each runner writes only its own shard, so no locks or atomics are needed
+void updateStats(StatShard *shard, int winner, int mode) {
+    int first = (mode == 1) ? 0 : 2; // Host/Guest in PVP, Player/Bot in PVE
+
+    if (mode != 1 && mode != 2) return;
+
+    shard->matches[first]++;
+    shard->matches[first + 1]++;
+
+    if (winner == 1) {
+        shard->wins[first]++;
+        shard->losses[first + 1]++;
+    } else if (winner == 2) {
+        shard->wins[first + 1]++;
+        shard->losses[first]++;
+    } else {
+        shard->draws[first]++;
+        shard->draws[first + 1]++;
+    }
+}
+
+// Tournament games count for the two engines that played them
+void updateEngineStats(StatShard *shard, int xEngine, int oEngine, int winner) {
+    int x = STAT_ENGINE_BASE + xEngine;
+    int o = STAT_ENGINE_BASE + oEngine;
+
+    shard->matches[x]++;
+    shard->matches[o]++;
+
+    if (winner == 1) {
+        shard->wins[x]++;
+        shard->losses[o]++;
+    } else if (winner == 2) {
+        shard->wins[o]++;
+        shard->losses[x]++;
+    } else {
+        shard->draws[x]++;
+        shard->draws[o]++;
+    }
+}
+
+// Folds every shard into the totals and clears it; called before the
+// statistics are shown or saved, while no game is recording
+void mergeStats(PlayerStats stats[STAT_PLAYERS]) {
+    for (int s = 0; s < statShardCount; s++) {
+        StatShard *shard = &statShards[s];
+        for (int i = 0; i < STAT_PLAYERS; i++) {
+            stats[i].matches += shard->matches[i];
+            stats[i].wins += shard->wins[i];
+            stats[i].losses += shard->losses[i];
+            stats[i].draws += shard->draws[i];
+        }
+        memset(shard, 0, sizeof(StatShard));
+    }
+}
+
+// -------------------------
+// Match History Functions
+// -------------------------
+// Queues the match for the writer thread; the caller records the result in
+// the statistics and then calls commitMatches
+void saveMatchResult(const char *p1, const char *p2, const char *winner, int mode, int boardSize) {
+    uint64_t head = persist.matchHead;
+
+    // A full queue means the writer is behind on a requested commit
+    if (head - ttt_atomicLoadAcquire64(&persist.matchTail) == PERSIST_QUEUE) {
+        ttt_mutexLock(&persist.lock);
+        while (head - ttt_atomicLoadAcquire64(&persist.matchTail) == PERSIST_QUEUE) {
+            ttt_conditionWait(&persist.progress, &persist.lock);
+        }
+        ttt_mutexUnlock(&persist.lock);
+    }
+
+    MatchRecord *record = &persist.matches[head % PERSIST_QUEUE];
+    strncpy(record->player1, p1, sizeof(record->player1) - 1);
+    record->player1[sizeof(record->player1) - 1] = '\0';
+    strncpy(record->player2, p2, sizeof(record->player2) - 1);
+    record->player2[sizeof(record->player2) - 1] = '\0';
+    strncpy(record->winner, winner, sizeof(record->winner) - 1);
+    record->winner[sizeof(record->winner) - 1] = '\0';
+    getCurrentTimestamp(record->timestamp);
+    record->boardSize = boardSize;
+    record->gameMode = mode;
+
+    ttt_atomicStoreRelease64(&persist.matchHead, head + 1);
+}
+
+// Asks for a group commit once PERSIST_BATCH matches are queued (or at once
+// when forced). Statistics are merged here, on the game thread, so the
+// writer only ever sees a finished copy.
+void commitMatches(int force) {
+    uint64_t head = persist.matchHead;
+    uint64_t next = persist.commitHead;
+
+    if (head - persist.requestedEnd < PERSIST_BATCH && !force) {
+        reportPersistErrors();
+        return;
+    }
+
+    if (next - ttt_atomicLoadAcquire64(&persist.commitTail) == PERSIST_COMMITS) {
+        ttt_mutexLock(&persist.lock);
+        while (next - ttt_atomicLoadAcquire64(&persist.commitTail) == PERSIST_COMMITS) {
+            ttt_conditionWait(&persist.progress, &persist.lock);
+        }
+        ttt_mutexUnlock(&persist.lock);
+    }
+
+    CommitRequest *request = &persist.commits[next % PERSIST_COMMITS];
+    mergeStats(gameStats);
+    memcpy(request->stats, gameStats, sizeof(request->stats));
+    request->end = head;
+    persist.requestedEnd = head;
+    ttt_atomicStoreRelease64(&persist.commitHead, next + 1);
+
+    if (persist.threaded) {
+        ttt_mutexLock(&persist.lock);
+        ttt_conditionSignal(&persist.wake);
+        ttt_mutexUnlock(&persist.lock);
+    } else {
+        runCommit();
+    }
+    reportPersistErrors();
+}
+
+// Commits everything queued and waits until it is on disk; used before the
+// history files are read
+void flushMatches() {
+    commitMatches(1);
+
+    ttt_mutexLock(&persist.lock);
+    while (ttt_atomicLoadAcquire64(&persist.commitTail) != persist.commitHead) {
+        ttt_conditionWait(&persist.progress, &persist.lock);
+    }
+    ttt_mutexUnlock(&persist.lock);
+
+    reportPersistErrors();
+}
+
+// Writes the oldest requested commit; returns 0 if none is waiting. Runs
+// on the writer thread, or on the game thread when there is no writer.
+int runCommit() {
+    uint64_t next = persist.commitTail;
+
+    if (next == ttt_atomicLoadAcquire64(&persist.commitHead)) return 0;
+
+    CommitRequest *request = &persist.commits[next % PERSIST_COMMITS];
+    uint64_t first = persist.matchTail;
+    int count = (int)(request->end - first);
+
+    for (int i = 0; i < count; i++) {
+        persist.batch[i] = persist.matches[(first + i) % PERSIST_QUEUE];
+    }
+    int failed = saveStats(request->stats, persist.batch, count);
+
+    // Failures are only printed by the game thread
+    if (failed) {
+        uint64_t errors;
+        do {
+            errors = ttt_atomicLoad64(&persist.errors);
+        } while (!ttt_atomicCompareSwap64(&persist.errors, errors, errors | (uint64_t)failed));
+    }
+
+    ttt_atomicStoreRelease64(&persist.matchTail, request->end);
+    ttt_atomicStoreRelease64(&persist.commitTail, next + 1);
+
+    ttt_mutexLock(&persist.lock);
+    ttt_conditionBroadcast(&persist.progress);
+    ttt_mutexUnlock(&persist.lock);
+    return 1;
+}
+
+// Prints the failures of commits that have finished since the last call
+void reportPersistErrors() {
+    uint64_t errors;
+
+    do {
+        errors = ttt_atomicLoad64(&persist.errors);
+    } while (errors != 0 && !ttt_atomicCompareSwap64(&persist.errors, errors, 0));
+
+    if (errors & PERSIST_STATS_FAILED) printf("Error: Unable to save statistics!\n");
+    if (errors & PERSIST_ARCHIVE_FAILED) printf("Error: Unable to archive match history!\n");
+    if (errors & PERSIST_MANIFEST_FAILED) printf("Error: Unable to update history manifest!\n");
+}
+
+void startPersistWriter() {
+    persist.matchHead = 0;
+    persist.matchTail = 0;
+    persist.commitHead = 0;
+    persist.commitTail = 0;
+    persist.errors = 0;
+    persist.shutdown = 0;
+    persist.requestedEnd = 0;
+    ttt_mutexInit(&persist.lock);
+    ttt_conditionInit(&persist.wake);
+    ttt_conditionInit(&persist.progress);
+
+    persist.threaded = ttt_threadStart(&persist.thread, persistWriter, NULL);
+}
+
+// Writes whatever is still queued, then lets the writer exit
+void stopPersistWriter() {
+    flushMatches();
+
+    if (persist.threaded) {
+        ttt_atomicStoreRelease64(&persist.shutdown, 1);
+        ttt_mutexLock(&persist.lock);
+        ttt_conditionSignal(&persist.wake);
+        ttt_mutexUnlock(&persist.lock);
+        ttt_threadJoin(persist.thread);
+    }
+
+    ttt_conditionDestroy(&persist.wake);
+    ttt_conditionDestroy(&persist.progress);
+    ttt_mutexDestroy(&persist.lock);
+}
+
+void *persistWriter(void *arg) {
+    (void)arg;
+
+    for (;;) {
+        if (runCommit()) continue;
+
+        // Nothing to write: sleep until a commit is requested
+        ttt_mutexLock(&persist.lock);
+        while (ttt_atomicLoadAcquire64(&persist.commitHead) == persist.commitTail &&
+               !ttt_atomicLoadAcquire64(&persist.shutdown)) {
+            ttt_conditionWait(&persist.wake, &persist.lock);
+        }
+        int idle = (ttt_atomicLoadAcquire64(&persist.commitHead) == persist.commitTail);
+        ttt_mutexUnlock(&persist.lock);
+
+        if (idle) break; // Shut down with nothing left to write
+    }
+
+    return NULL;
+}
+
+void writeMatchRecord(FILE *file, MatchRecord *record) {
+    fprintf(file, "Date & Time: %s", record->timestamp);
+    fprintf(file, "Board Size: %s\n", boardSizeName(record->boardSize));
+    fprintf(file, "Game Mode: %s\n", (record->gameMode == 1) ? "PVP" : (record->gameMode == 2) ? "PVE" : "EVE");
+    fprintf(file, "Player 1: %s (X)\n", record->player1);
+    fprintf(file, "Player 2: %s (O)\n", record->player2);
+    fprintf(file, "Winner: %s\n", record->winner);
+    fprintf(file, "=====================================\n");
+}
+
+// Keeps game_data.txt small: once it holds more than HISTORY_SEGMENT_CAP
+// matches, the oldest ARCHIVE_BATCH are compacted into a new archive segment.
+// Returns the PERSIST_* failures, 0 if nothing went wrong.
+int rotateMatchHistory() {
+    FILE *file = fopen("game_data.txt", "r");
+    if (file == NULL) return 0;
+
+    char header[4096] = "";
+    char line[200];
+    int inHistory = 0;
+    int count = 0;
+    int capacity = HISTORY_SEGMENT_CAP + 1;
+    MatchRecord *records = (MatchRecord *)malloc(capacity * sizeof(MatchRecord));
+    MatchRecord current;
+
+    if (records == NULL) {
+        fclose(file);
+        return PERSIST_ARCHIVE_FAILED;
+    }
+    memset(&current, 0, sizeof(current));
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (!inHistory) {
+            if (strlen(header) + strlen(line) < sizeof(header)) strcat(header, line);
+            if (strstr(line, "=== MATCH HISTORY ===") != NULL) inHistory = 1;
+            continue;
+        }
+
+        char *value = strchr(line, ':');
+        value = (value != NULL) ? value + 2 : line;
+
+        if (strncmp(line, "Date & Time:", 12) == 0) {
+            snprintf(current.timestamp, sizeof(current.timestamp), "%.98s", value);
+            current.playedAt = parseTimestamp(value);
+        } else if (strncmp(line, "Board Size:", 11) == 0) {
+            for (int code = 3; code <= GOMOKU_BOARD; code++) {
+                if (strncmp(value, boardSizeName(code), strlen(boardSizeName(code))) == 0 &&
+                    value[strlen(boardSizeName(code))] == '\n') {
+                    current.boardSize = code;
+                }
+            }
+        } else if (strncmp(line, "Game Mode:", 10) == 0) {
+            current.gameMode = (strncmp(value, "PVP", 3) == 0) ? 1 : (strncmp(value, "PVE", 3) == 0) ? 2 : 3;
+        } else if (strncmp(line, "Player 1:", 9) == 0) {
+            sscanf(value, "%49[^(\n]", current.player1);
+            trimTrailingSpaces(current.player1);
+        } else if (strncmp(line, "Player 2:", 9) == 0) {
+            sscanf(value, "%49[^(\n]", current.player2);
+            trimTrailingSpaces(current.player2);
+        } else if (strncmp(line, "Winner:", 7) == 0) {
+            sscanf(value, "%49[^\n]", current.winner);
+        } else if (strncmp(line, "=====", 5) == 0) {
+            if (count == capacity) {
+                capacity *= 2;
+                MatchRecord *grown = (MatchRecord *)realloc(records, capacity * sizeof(MatchRecord));
+                if (grown == NULL) break;
+                records = grown;
+            }
+            records[count++] = current;
+            memset(&current, 0, sizeof(current));
+        }
+    }
+    fclose(file);
+
+    // Next segment number follows the entries already in the manifest
+    int segment = 1;
+    FILE *manifest = fopen(ARCHIVE_MANIFEST, "r");
+    if (manifest != NULL) {
+        while (fgets(line, sizeof(line), manifest) != NULL) segment++;
+        fclose(manifest);
+    }
+
+    char segmentName[64];
+    sprintf(segmentName, "history_%04d.dat", segment);
+
+    // A segment past the end of the manifest is left by a rotation that
+    // stopped before its manifest entry was written. If the live file no
+    // longer starts with its matches, the rewrite went through and only the
+    // entry is missing; otherwise the segment is simply written again.
+    MatchRecord *orphan;
+    int orphanCount = readArchiveSegment(segmentName, &orphan);
+    if (orphan != NULL) {
+        int stillLive = (orphanCount <= count && sameMatches(orphan, records, orphanCount));
+
+        if (orphanCount > 0 && !stillLive) {
+            if (!appendManifestEntry(segmentName, orphan, orphanCount)) {
+                free(orphan);
+                free(records);
+                return PERSIST_MANIFEST_FAILED;
+            }
+            segment++;
+            sprintf(segmentName, "history_%04d.dat", segment);
+        }
+        free(orphan);
+    }
+
+    if (count <= HISTORY_SEGMENT_CAP) {
+        free(records);
+        return 0;
+    }
+
+    if (!writeArchiveSegment(segmentName, records, ARCHIVE_BATCH)) {
+        free(records);
+        return PERSIST_ARCHIVE_FAILED;
+    }
+
+    // Rewrite the live file with the matches that were not archived. The
+    // manifest entry comes last: until the live file is replaced the
+    // matches are still there, and the segment is not listed.
+    file = fopen("temp_complete_file.txt", "w");
+    if (file == NULL) {
+        remove(segmentName);
+        free(records);
+        return PERSIST_ARCHIVE_FAILED;
+    }
+    fprintf(file, "%s", header);
+    for (int i = ARCHIVE_BATCH; i < count; i++) {
+        writeMatchRecord(file, &records[i]);
+    }
+    if (!closeSynced(file) || !replaceFile("temp_complete_file.txt", "game_data.txt")) {
+        remove("temp_complete_file.txt");
+        remove(segmentName);
+        free(records);
+        return PERSIST_ARCHIVE_FAILED;
+    }
+
+    // Should this fail, the next rotation finds the segment and lists it
+    int failed = appendManifestEntry(segmentName, records, ARCHIVE_BATCH) ? 0 : PERSIST_MANIFEST_FAILED;
+    free(records);
+    return failed;
+}
+
+// Closes the file once its contents are on the disk, not just handed to
+// the operating system; returns 1 if both worked
+int closeSynced(FILE *file) {
+    int synced = (fflush(file) == 0);
+
+#ifdef _WIN32
+    synced = synced && _commit(_fileno(file)) == 0;
+#else
+    synced = synced && fsync(fileno(file)) == 0;
+#endif
+    return (fclose(file) == 0) && synced;
+}
+
+// Moves temp over target in one step, so a reader sees either the old
+// file or the new one. The rename is itself synced, through the directory,
+// so it cannot be lost once this returns.
+int replaceFile(const char *temp, const char *target) {
+#ifdef _WIN32
+    return MoveFileExA(temp, target, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (rename(temp, target) != 0) return 0;
+
+    int directory = open(".", O_RDONLY);
+    if (directory >= 0) {
+        fsync(directory);
+        close(directory);
+    }
+    return 1;
+#endif
+}
+
+void displayMatchHistory() {
+    // Commit queued matches so the history shown is complete
+    flushMatches();
 
-void displayMatchHistory() {
     FILE *file = fopen("game_data.txt", "r");
     if (file == NULL) {
         printf("\nNo match history found!\n");
@@ -680,6 +2395,295 @@ void displayMatchHistory() {
     }
 
     fclose(file);
+
+    displayArchivedHistory();
+}
+
+// -------------------------
+// History Archive Functions
+// -------------------------
+// Archive segments are small binary blocks:
+//   "TTTA", version, record count, base time (8 bytes),
+//   name dictionary (count, then length + bytes per name),
+//   then per record: zigzag varint time delta, three name indexes
+//   (player 1, player 2, winner) and one byte of board size and mode.
+time_t parseTimestamp(const char *text) {
+    const char *months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    char weekday[4], month[4];
+    struct tm parts;
+
+    memset(&parts, 0, sizeof(parts));
+    if (sscanf(text, "%3s %3s %d %d:%d:%d %d", weekday, month, &parts.tm_mday,
+               &parts.tm_hour, &parts.tm_min, &parts.tm_sec, &parts.tm_year) != 7) {
+        return 0;
+    }
+
+    const char *found = strstr(months, month);
+    parts.tm_mon = (found != NULL) ? (int)(found - months) / 3 : 0;
+    parts.tm_year -= 1900;
+    parts.tm_isdst = -1;
+    return mktime(&parts);
+}
+
+void putVarint(FILE *file, uint64_t value) {
+    while (value >= 0x80) {
+        fputc((int)(value & 0x7F) | 0x80, file);
+        value >>= 7;
+    }
+    fputc((int)value, file);
+}
+
+uint64_t getVarint(FILE *file) {
+    uint64_t value = 0;
+    int shift = 0;
+    int byte;
+
+    while ((byte = fgetc(file)) != EOF) {
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) break;
+        shift += 7;
+    }
+    return value;
+}
+
+int archiveNameIndex(char names[][50], int *nameCount, const char *name) {
+    for (int i = 0; i < *nameCount; i++) {
+        if (strcmp(names[i], name) == 0) return i;
+    }
+    if (*nameCount == ARCHIVE_MAX_NAMES) return -1;
+    strcpy(names[*nameCount], name);
+    return (*nameCount)++;
+}
+
+int writeArchiveSegment(const char *filename, MatchRecord *records, int count) {
+    static char names[ARCHIVE_MAX_NAMES][50];
+    int nameCount = 0;
+    unsigned char *codes = (unsigned char *)malloc(count * 3);
+
+    if (codes == NULL) return 0;
+
+    // Build the name dictionary first so it can precede the records
+    for (int i = 0; i < count; i++) {
+        int a = archiveNameIndex(names, &nameCount, records[i].player1);
+        int b = archiveNameIndex(names, &nameCount, records[i].player2);
+        int c = archiveNameIndex(names, &nameCount, records[i].winner);
+        if (a < 0 || b < 0 || c < 0) {
+            free(codes);
+            return 0;
+        }
+        codes[i * 3] = (unsigned char)a;
+        codes[i * 3 + 1] = (unsigned char)b;
+        codes[i * 3 + 2] = (unsigned char)c;
+    }
+
+    FILE *file = fopen(filename, "wb");
+    if (file == NULL) {
+        free(codes);
+        return 0;
+    }
+
+    fwrite("TTTA", 1, 4, file);
+    fputc(1, file);
+    putVarint(file, (uint64_t)count);
+    uint64_t base = (uint64_t)(long long)records[0].playedAt;
+    for (int i = 0; i < 8; i++) {
+        fputc((int)((base >> (i * 8)) & 0xFF), file);
+    }
+
+    fputc(nameCount, file);
+    for (int i = 0; i < nameCount; i++) {
+        int length = (int)strlen(names[i]);
+        fputc(length, file);
+        fwrite(names[i], 1, length, file);
+    }
+
+    long long previous = (long long)records[0].playedAt;
+    for (int i = 0; i < count; i++) {
+        long long delta = (long long)records[i].playedAt - previous;
+        previous = (long long)records[i].playedAt;
+        putVarint(file, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+        fwrite(&codes[i * 3], 1, 3, file);
+        fputc((records[i].boardSize << 2) | records[i].gameMode, file);
+    }
+
+    free(codes);
+    return closeSynced(file);
+}
+
+int readArchiveSegment(const char *filename, MatchRecord **records) {
+    static char names[ARCHIVE_MAX_NAMES][50];
+    char magic[4];
+    FILE *file = fopen(filename, "rb");
+
+    *records = NULL;
+    if (file == NULL) return 0;
+
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, "TTTA", 4) != 0 || fgetc(file) != 1) {
+        fclose(file);
+        return 0;
+    }
+
+    long start = ftell(file);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, start, SEEK_SET);
+
+    // Every record takes at least five bytes, so a count the rest of the
+    // file cannot hold is corrupt rather than a reason to allocate
+    uint64_t stored = getVarint(file);
+    if (start < 0 || size < start || stored > (uint64_t)(size - start) / 5) {
+        fclose(file);
+        return 0;
+    }
+
+    int count = (int)stored;
+    uint64_t base = 0;
+    for (int i = 0; i < 8; i++) {
+        base |= (uint64_t)(fgetc(file) & 0xFF) << (i * 8);
+    }
+
+    int nameCount = fgetc(file);
+    for (int i = 0; i < nameCount; i++) {
+        int length = fgetc(file);
+        if (length < 0 || length > 49 || fread(names[i], 1, length, file) != (size_t)length) {
+            fclose(file);
+            return 0;
+        }
+        names[i][length] = '\0';
+    }
+
+    *records = (MatchRecord *)calloc(count, sizeof(MatchRecord));
+    if (*records == NULL) {
+        fclose(file);
+        return 0;
+    }
+
+    long long previous = (long long)base;
+    for (int i = 0; i < count; i++) {
+        MatchRecord *record = &(*records)[i];
+        uint64_t zigzag = getVarint(file);
+        long long delta = (long long)(zigzag >> 1) ^ -(long long)(zigzag & 1);
+        unsigned char codes[4];
+
+        if (fread(codes, 1, 4, file) != 4 || codes[0] >= nameCount ||
+            codes[1] >= nameCount || codes[2] >= nameCount) {
+            count = i;
+            break;
+        }
+
+        previous += delta;
+        record->playedAt = (time_t)previous;
+        strcpy(record->timestamp, ctime(&record->playedAt));
+        strcpy(record->player1, names[codes[0]]);
+        strcpy(record->player2, names[codes[1]]);
+        strcpy(record->winner, names[codes[2]]);
+        record->boardSize = codes[3] >> 2;
+        record->gameMode = codes[3] & 3;
+    }
+
+    fclose(file);
+    return count;
+}
+
+// Lists a new segment by rewriting the manifest through a temporary file
+int appendManifestEntry(const char *segmentName, MatchRecord *records, int count) {
+    FILE *manifest = fopen(ARCHIVE_MANIFEST, "r");
+    FILE *file = fopen("history_manifest.tmp", "w");
+    char line[200];
+
+    if (file == NULL) {
+        if (manifest != NULL) fclose(manifest);
+        return 0;
+    }
+    if (manifest != NULL) {
+        while (fgets(line, sizeof(line), manifest) != NULL) fputs(line, file);
+        fclose(manifest);
+    }
+    fprintf(file, "%s %lld %lld %d\n", segmentName,
+            (long long)records[0].playedAt, (long long)records[count - 1].playedAt, count);
+
+    if (!closeSynced(file) || !replaceFile("history_manifest.tmp", ARCHIVE_MANIFEST)) {
+        remove("history_manifest.tmp");
+        return 0;
+    }
+    return 1;
+}
+
+// Whether two runs of matches hold the same games, as far as an archive
+// segment records them
+int sameMatches(MatchRecord *a, MatchRecord *b, int count) {
+    for (int i = 0; i < count; i++) {
+        if (a[i].playedAt != b[i].playedAt || a[i].boardSize != b[i].boardSize ||
+            a[i].gameMode != b[i].gameMode || strcmp(a[i].player1, b[i].player1) != 0 ||
+            strcmp(a[i].player2, b[i].player2) != 0 || strcmp(a[i].winner, b[i].winner) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Reads the manifest and opens only the segments the user asks for
+void displayArchivedHistory() {
+    FILE *manifest = fopen(ARCHIVE_MANIFEST, "r");
+    char (*segmentNames)[64] = NULL;
+    int capacity = 0;
+    int segments = 0;
+    int archived = 0;
+    char line[200];
+
+    if (manifest == NULL) return;
+
+    // The list grows with the manifest so the newest segments are never cut off
+    while (fgets(line, sizeof(line), manifest) != NULL) {
+        char name[64];
+        int count;
+        long long first, last;
+        if (sscanf(line, "%63s %lld %lld %d", name, &first, &last, &count) != 4) continue;
+
+        if (segments == capacity) {
+            int grown = (capacity == 0) ? 64 : capacity * 2;
+            char (*names)[64] = realloc(segmentNames, grown * sizeof(*segmentNames));
+            if (names == NULL) break;
+            segmentNames = names;
+            capacity = grown;
+        }
+        strcpy(segmentNames[segments++], name);
+        archived += count;
+    }
+    fclose(manifest);
+
+    if (segments == 0) {
+        free(segmentNames);
+        return;
+    }
+
+    int wanted;
+    printf("\n%d older matches are archived in %d segments.\n", archived, segments);
+    printf("How many of the most recent segments to show (0 = none): ");
+    scanf("%d", &wanted);
+    clearInputBuffer();
+
+    if (wanted <= 0) {
+        free(segmentNames);
+        return;
+    }
+    if (wanted > segments) wanted = segments;
+
+    printf("\n=== ARCHIVED MATCH HISTORY ===\n");
+    for (int s = segments - wanted; s < segments; s++) {
+        MatchRecord *records;
+        int count = readArchiveSegment(segmentNames[s], &records);
+
+        if (records == NULL) {
+            printf("Error: Unable to read %s!\n", segmentNames[s]);
+            continue;
+        }
+        for (int i = 0; i < count; i++) {
+            writeMatchRecord(stdout, &records[i]);
+        }
+        free(records);
+    }
+    free(segmentNames);
 }
 
 void displayFullStats() {
@@ -708,4 +2712,11 @@ void getCurrentTimestamp(char *buffer) {
     time_t now;
     time(&now);
     strcpy(buffer, ctime(&now));
+}
+
+void trimTrailingSpaces(char *text) {
+    int len = strlen(text);
+    while (len > 0 && (text[len - 1] == ' ' || text[len - 1] == '\n')) {
+        text[--len] = '\0';
+    }
 }
\ No newline at end of file
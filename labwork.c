@@ -1,69 +1,665 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+// Snapshot layout (native byte order, written and read in whole arrays):
+//   struct SnapshotHeader
+//   struct University[uniCount]
+//   struct Student[stuCount]
+//   int idIndex[idCap]
+//   struct DeptEntry[deptCap]
+// The arrays are stored exactly as they sit in memory, indexes included,
+// so a reload is a handful of fread calls with nothing rebuilt.
+#define SNAPSHOT_MAGIC   0x5342414C  // "LABS"
+#define SNAPSHOT_VERSION 2          // 2: ids hashed with fmix32
+#define INITIAL_CAP      16
+#define EMPTY_SLOT       -1
+
 struct University{
 
     char uniName[64];
     char address[256];
     int uniCode;
 
-    struct Student {
-        char stuName[64];
-        char dept[64];
-        int id;
-    }stu[5],stu1;
+};
+
+struct Student {
+    char stuName[64];
+    char dept[64];
+    int id;
+    int uniCode;
+    int nextInDept;     // Next student of the same dept, -1 at the end
+};
+
+struct DeptEntry {
+    char dept[64];
+    int head;           // First student of the dept, -1 for an empty slot
+    int count;
+};
+
+struct Registry {
+    struct University *unis;
+    int uniCount, uniCap;
+
+    struct Student *stu;
+    int stuCount, stuCap;
 
-}uni,unil[5];
+    int *idIndex;       // Open addressing on id, holds student positions
+    int idCap;          // Power of two
+
+    struct DeptEntry *depts;
+    int deptCount, deptCap;
+};
+
+struct SnapshotHeader {
+    int magic;
+    int version;
+    int uniCount;
+    int stuCount;
+    int idCap;
+    int deptCount;
+    int deptCap;
+};
+
+struct Registry reg;
+
+void initRegistry(struct Registry *r);
+void freeRegistry(struct Registry *r);
+int growArray(void **array, int *cap, int count, size_t itemSize);
+unsigned int hashId(int id);
+unsigned int hashDept(const char *dept);
+int idSlot(struct Registry *r, int id);
+int deptSlot(struct Registry *r, const char *dept);
+int growIndexes(struct Registry *r);
+int addUniversity(struct Registry *r, int code, const char *name, const char *address);
+struct University *findUniversity(struct Registry *r, int code);
+int addStudent(struct Registry *r, const char *name, const char *dept, int id, int uniCode);
+struct Student *findStudent(struct Registry *r, int id);
+struct DeptEntry *findDept(struct Registry *r, const char *dept);
+void printStudent(struct Registry *r, struct Student *s);
+void printDept(struct Registry *r, const char *dept);
+int loadCSV(struct Registry *r, const char *filename);
+int saveSnapshot(struct Registry *r, const char *filename);
+int loadSnapshot(struct Registry *r, const char *filename);
+int snapshotValid(struct Registry *r);
 
 int main()
 {
-    int n;
-    printf("How many students?: ");
-    scanf("%d",&n);
-    for (int i = 0; i < n; i++)
+    int choice;
+    char name[64], dept[64], address[256], file[256];
+    int id, code, n;
+
+    initRegistry(&reg);
+
+    do
     {
+        printf("\n=== STUDENT REGISTRY (%d universities, %d students) ===\n",
+               reg.uniCount, reg.stuCount);
+        printf("1. Add university\n");
+        printf("2. Add students\n");
+        printf("3. Find student by ID\n");
+        printf("4. List students of a dept\n");
+        printf("5. List all students\n");
+        printf("6. Load CSV file\n");
+        printf("7. Save snapshot\n");
+        printf("8. Load snapshot\n");
+        printf("0. Exit\n");
+        printf("Enter choice: ");
+        if (scanf("%d",&choice) != 1)
+        {
+            break;
+        }
+
+        switch (choice)
+        {
+        case 1:
+            printf("Enter University Code: ");
+            scanf("%d",&code);
+            printf("Enter University Name: ");
+            scanf(" %63[^\n]",name);
+            printf("Enter Address: ");
+            scanf(" %255[^\n]",address);
+            if (!addUniversity(&reg, code, name, address))
+            {
+                printf("University %d already exists!\n", code);
+            }
+            break;
+
+        case 2:
+            printf("How many students?: ");
+            scanf("%d",&n);
+            for (int i = 0; i < n; i++)
+            {
+                printf("Enter Student Name: ");
+                scanf("%63s",name);
+                printf("Enter dept.:");
+                scanf("%63s",dept);
+                printf("Enter ID:");
+                scanf("%d",&id);
+                printf("Enter University Code:");
+                scanf("%d",&code);
+
+                if (!addStudent(&reg, name, dept, id, code))
+                {
+                    printf("ID %d is already registered!\n", id);
+                }
+            }
+            break;
+
+        case 3:
+            printf("Enter ID:");
+            scanf("%d",&id);
+            if (findStudent(&reg, id) != NULL)
+            {
+                printStudent(&reg, findStudent(&reg, id));
+            }
+            else
+            {
+                printf("No student with ID %d\n", id);
+            }
+            break;
+
+        case 4:
+            printf("Enter dept.:");
+            scanf("%63s",dept);
+            printDept(&reg, dept);
+            break;
+
+        case 5:
+            printf("Student Info: \n\tName: \tDept: \tID: \tUniversity:\n");
+            for (int i = 0; i < reg.stuCount; i++)
+            {
+                printStudent(&reg, &reg.stu[i]);
+            }
+            break;
+
+        case 6:
+            printf("CSV file: ");
+            scanf("%255s",file);
+            n = loadCSV(&reg, file);
+            if (n < 0)
+            {
+                printf("Cannot open %s\n", file);
+            }
+            else
+            {
+                printf("Loaded %d records\n", n);
+            }
+            break;
+
+        case 7:
+            printf("Snapshot file: ");
+            scanf("%255s",file);
+            if (saveSnapshot(&reg, file))
+            {
+                printf("Saved %d students to %s\n", reg.stuCount, file);
+            }
+            else
+            {
+                printf("Cannot write %s\n", file);
+            }
+            break;
+
+        case 8:
+            printf("Snapshot file: ");
+            scanf("%255s",file);
+            if (loadSnapshot(&reg, file))
+            {
+                printf("Loaded %d students from %s\n", reg.stuCount, file);
+            }
+            else
+            {
+                printf("%s is not a valid snapshot\n", file);
+            }
+            break;
 
-//    puts(uni.uniName);
+        case 0:
+            break;
 
-    printf("Enter Student Name: ");
-    scanf("%s",&uni.stu[i].stuName);
-    printf("Enter dept.:");
-    scanf("%s",&uni.stu[i].dept);
-    printf("Enter ID:");
-    scanf("%d",&uni.stu[i].id);
+        default:
+            printf("Invalid choice!\n");
+        }
+    } while (choice != 0);
 
-//    printf("Student Info: \n\tName: %s\n\tDept: %s\n\tID: %d\n",
-//           unil[i].stu1.stuName, unil[i].stu1.dept, unil[i].stu1.id);
+    freeRegistry(&reg);
+    return 0;
+}
+
+void initRegistry(struct Registry *r)
+{
+    memset(r, 0, sizeof(*r));
+
+    r->idCap = INITIAL_CAP;
+    r->idIndex = malloc(r->idCap * sizeof(int));
+    for (int i = 0; i < r->idCap; i++)
+    {
+        r->idIndex[i] = EMPTY_SLOT;
     }
-    printf("Student Info: \n\tName: \tDept: \tID: \n");
 
-    for (int i = 0; i < n; i++)
+    r->deptCap = INITIAL_CAP;
+    r->depts = malloc(r->deptCap * sizeof(struct DeptEntry));
+    for (int i = 0; i < r->deptCap; i++)
     {
-        printf(" \n\t %s\t %s\t %d\n",
-           uni.stu[i].stuName, uni.stu[i].dept, uni.stu[i].id);
+        r->depts[i].head = EMPTY_SLOT;
     }
+}
 
-//    strcpy(uni.uniName,"NSU");
-//    puts(uni.uniName);
-//
-//    printf("Enter Student Name: ");
-//    gets(uni.stu1.stuName);
-//    printf("Enter dept.:");
-//    gets(uni.stu1.dept);
-//    printf("Enter ID:");
-//    scanf("%d",&uni.stu1.id);
-//
-//    printf("Student Info: \n\tName: %s\n\tDept: %s\n\tID: %d\n",
-//           uni.stu1.stuName, uni.stu1.dept, uni.stu1.id);
+void freeRegistry(struct Registry *r)
+{
+    free(r->unis);
+    free(r->stu);
+    free(r->idIndex);
+    free(r->depts);
+    memset(r, 0, sizeof(*r));
+}
 
-    int x;
-    printf("\n\nEnter x to continue:");
-    scanf("%d",&x);
+// Doubles the capacity when the array is full; returns 0 if out of memory
+int growArray(void **array, int *cap, int count, size_t itemSize)
+{
+    if (count < *cap)
+    {
+        return 1;
+    }
 
-    if (x == 1)
+    int newCap = (*cap == 0) ? INITIAL_CAP : *cap * 2;
+    void *grown = realloc(*array, newCap * itemSize);
+    if (grown == NULL)
     {
-        system("cls");
+        return 0;
     }
 
-    return 0;
+    *array = grown;
+    *cap = newCap;
+    return 1;
+}
+
+// murmur3's fmix32 finalizer: every input bit reaches the low bits that
+// idSlot masks, so strided ids (k * 4096, ...) still spread evenly
+unsigned int hashId(int id)
+{
+    unsigned int h = (unsigned int)id;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+unsigned int hashDept(const char *dept)
+{
+    unsigned int h = 2166136261u;
+    while (*dept)
+    {
+        h = (h ^ (unsigned char)*dept++) * 16777619u;
+    }
+    return h;
+}
+
+// Slot holding the id, or the empty slot where it would go
+int idSlot(struct Registry *r, int id)
+{
+    int mask = r->idCap - 1;
+    int slot = hashId(id) & mask;
+
+    while (r->idIndex[slot] != EMPTY_SLOT && r->stu[r->idIndex[slot]].id != id)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+int deptSlot(struct Registry *r, const char *dept)
+{
+    int mask = r->deptCap - 1;
+    int slot = hashDept(dept) & mask;
+
+    while (r->depts[slot].head != EMPTY_SLOT && strcmp(r->depts[slot].dept, dept) != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Keeps both tables under 3/4 full so probes stay short
+int growIndexes(struct Registry *r)
+{
+    if ((r->stuCount + 1) * 4 > r->idCap * 3)
+    {
+        int *old = r->idIndex;
+        int oldCap = r->idCap;
+        int *grown = malloc(oldCap * 2 * sizeof(int));
+        if (grown == NULL)
+        {
+            return 0;
+        }
+
+        r->idIndex = grown;
+        r->idCap = oldCap * 2;
+        for (int i = 0; i < r->idCap; i++)
+        {
+            r->idIndex[i] = EMPTY_SLOT;
+        }
+        for (int i = 0; i < oldCap; i++)
+        {
+            if (old[i] != EMPTY_SLOT)
+            {
+                r->idIndex[idSlot(r, r->stu[old[i]].id)] = old[i];
+            }
+        }
+        free(old);
+    }
+
+    if ((r->deptCount + 1) * 4 > r->deptCap * 3)
+    {
+        struct DeptEntry *old = r->depts;
+        int oldCap = r->deptCap;
+        struct DeptEntry *grown = malloc(oldCap * 2 * sizeof(struct DeptEntry));
+        if (grown == NULL)
+        {
+            return 0;
+        }
+
+        r->depts = grown;
+        r->deptCap = oldCap * 2;
+        for (int i = 0; i < r->deptCap; i++)
+        {
+            r->depts[i].head = EMPTY_SLOT;
+        }
+        for (int i = 0; i < oldCap; i++)
+        {
+            if (old[i].head != EMPTY_SLOT)
+            {
+                r->depts[deptSlot(r, old[i].dept)] = old[i];
+            }
+        }
+        free(old);
+    }
+
+    return 1;
+}
+
+int addUniversity(struct Registry *r, int code, const char *name, const char *address)
+{
+    if (findUniversity(r, code) != NULL)
+    {
+        return 0;
+    }
+    if (!growArray((void **)&r->unis, &r->uniCap, r->uniCount, sizeof(struct University)))
+    {
+        return 0;
+    }
+
+    struct University *u = &r->unis[r->uniCount++];
+    snprintf(u->uniName, sizeof(u->uniName), "%s", name);
+    snprintf(u->address, sizeof(u->address), "%s", address);
+    u->uniCode = code;
+    return 1;
+}
+
+// Universities are few, so a scan is enough here
+struct University *findUniversity(struct Registry *r, int code)
+{
+    for (int i = 0; i < r->uniCount; i++)
+    {
+        if (r->unis[i].uniCode == code)
+        {
+            return &r->unis[i];
+        }
+    }
+    return NULL;
+}
+
+// Returns 0 if the id is taken (or memory ran out)
+int addStudent(struct Registry *r, const char *name, const char *dept, int id, int uniCode)
+{
+    if (findStudent(r, id) != NULL)
+    {
+        return 0;
+    }
+    if (!growIndexes(r) ||
+        !growArray((void **)&r->stu, &r->stuCap, r->stuCount, sizeof(struct Student)))
+    {
+        return 0;
+    }
+
+    int pos = r->stuCount++;
+    struct Student *s = &r->stu[pos];
+    snprintf(s->stuName, sizeof(s->stuName), "%s", name);
+    snprintf(s->dept, sizeof(s->dept), "%s", dept);
+    s->id = id;
+    s->uniCode = uniCode;
+
+    r->idIndex[idSlot(r, id)] = pos;
+
+    // New students go to the front of their dept's list
+    struct DeptEntry *d = &r->depts[deptSlot(r, s->dept)];
+    if (d->head == EMPTY_SLOT)
+    {
+        snprintf(d->dept, sizeof(d->dept), "%s", s->dept);
+        d->count = 0;
+        r->deptCount++;
+    }
+    s->nextInDept = d->head;
+    d->head = pos;
+    d->count++;
+
+    return 1;
+}
+
+struct Student *findStudent(struct Registry *r, int id)
+{
+    int slot = idSlot(r, id);
+    return (r->idIndex[slot] == EMPTY_SLOT) ? NULL : &r->stu[r->idIndex[slot]];
+}
+
+struct DeptEntry *findDept(struct Registry *r, const char *dept)
+{
+    int slot = deptSlot(r, dept);
+    return (r->depts[slot].head == EMPTY_SLOT) ? NULL : &r->depts[slot];
+}
+
+void printStudent(struct Registry *r, struct Student *s)
+{
+    struct University *u = findUniversity(r, s->uniCode);
+
+    printf(" \n\t %s\t %s\t %d\t %s\n",
+           s->stuName, s->dept, s->id, (u != NULL) ? u->uniName : "-");
+}
+
+void printDept(struct Registry *r, const char *dept)
+{
+    struct DeptEntry *d = findDept(r, dept);
+
+    if (d == NULL)
+    {
+        printf("No students in %s\n", dept);
+        return;
+    }
+
+    printf("%s: %d students\n", d->dept, d->count);
+    for (int i = d->head; i != EMPTY_SLOT; i = r->stu[i].nextInDept)
+    {
+        printStudent(r, &r->stu[i]);
+    }
+}
+
+// One record per line:
+//   U,<code>,<name>,<address>
+//   S,<id>,<name>,<dept>,<uniCode>
+// Returns the number of records added, or -1 if the file cannot be opened.
+int loadCSV(struct Registry *r, const char *filename)
+{
+    FILE *fp = fopen(filename, "r");
+    char line[512], name[64], dept[64], address[256];
+    int id, code, added = 0;
+
+    if (fp == NULL)
+    {
+        return -1;
+    }
+
+    // A large stdio buffer keeps big files to a few read calls
+    setvbuf(fp, NULL, _IOFBF, 1 << 16);
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        if (sscanf(line, "S,%d,%63[^,],%63[^,],%d", &id, name, dept, &code) == 4)
+        {
+            added += addStudent(r, name, dept, id, code);
+        }
+        else if (sscanf(line, "U,%d,%63[^,],%255[^\r\n]", &code, name, address) == 3)
+        {
+            added += addUniversity(r, code, name, address);
+        }
+    }
+
+    fclose(fp);
+    return added;
+}
+
+int saveSnapshot(struct Registry *r, const char *filename)
+{
+    FILE *fp = fopen(filename, "wb");
+    struct SnapshotHeader h = {SNAPSHOT_MAGIC, SNAPSHOT_VERSION, r->uniCount, r->stuCount,
+                               r->idCap, r->deptCount, r->deptCap};
+    int ok;
+
+    if (fp == NULL)
+    {
+        return 0;
+    }
+
+    ok = fwrite(&h, sizeof(h), 1, fp) == 1 &&
+         fwrite(r->unis, sizeof(struct University), r->uniCount, fp) == (size_t)r->uniCount &&
+         fwrite(r->stu, sizeof(struct Student), r->stuCount, fp) == (size_t)r->stuCount &&
+         fwrite(r->idIndex, sizeof(int), r->idCap, fp) == (size_t)r->idCap &&
+         fwrite(r->depts, sizeof(struct DeptEntry), r->deptCap, fp) == (size_t)r->deptCap;
+
+    return (fclose(fp) == 0) && ok;
+}
+
+// Replaces the registry with the snapshot; the registry is left unchanged
+// if the file is not a complete snapshot
+int loadSnapshot(struct Registry *r, const char *filename)
+{
+    FILE *fp = fopen(filename, "rb");
+    struct SnapshotHeader h;
+    struct Registry loaded;
+
+    if (fp == NULL)
+    {
+        return 0;
+    }
+    if (fread(&h, sizeof(h), 1, fp) != 1 || h.magic != SNAPSHOT_MAGIC ||
+        h.version != SNAPSHOT_VERSION || h.uniCount < 0 || h.stuCount < 0 ||
+        h.idCap < INITIAL_CAP || (h.idCap & (h.idCap - 1)) != 0 ||
+        h.deptCap < INITIAL_CAP || (h.deptCap & (h.deptCap - 1)) != 0)
+    {
+        fclose(fp);
+        return 0;
+    }
+
+    memset(&loaded, 0, sizeof(loaded));
+    loaded.uniCount = loaded.uniCap = h.uniCount;
+    loaded.stuCount = loaded.stuCap = h.stuCount;
+    loaded.idCap = h.idCap;
+    loaded.deptCount = h.deptCount;
+    loaded.deptCap = h.deptCap;
+    loaded.unis = malloc((h.uniCount + 1) * sizeof(struct University));
+    loaded.stu = malloc((h.stuCount + 1) * sizeof(struct Student));
+    loaded.idIndex = malloc(h.idCap * sizeof(int));
+    loaded.depts = malloc(h.deptCap * sizeof(struct DeptEntry));
+
+    int ok = loaded.unis != NULL && loaded.stu != NULL && loaded.idIndex != NULL && loaded.depts != NULL &&
+             fread(loaded.unis, sizeof(struct University), h.uniCount, fp) == (size_t)h.uniCount &&
+             fread(loaded.stu, sizeof(struct Student), h.stuCount, fp) == (size_t)h.stuCount &&
+             fread(loaded.idIndex, sizeof(int), h.idCap, fp) == (size_t)h.idCap &&
+             fread(loaded.depts, sizeof(struct DeptEntry), h.deptCap, fp) == (size_t)h.deptCap;
+    fclose(fp);
+
+    if (!ok || !snapshotValid(&loaded))
+    {
+        freeRegistry(&loaded);
+        return 0;
+    }
+
+    freeRegistry(r);
+    *r = loaded;
+    return 1;
+}
+
+// The stored indexes are used without being rebuilt, so every position in
+// them must be in range, both hash tables must keep a free slot (the
+// probes stop only there) and no dept list may loop
+int snapshotValid(struct Registry *r)
+{
+    int freeIds = 0, freeDepts = 0, usedDepts = 0, listed = 0;
+
+    if (r->deptCount < 0 || r->deptCount > r->deptCap)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < r->uniCount; i++)
+    {
+        if (memchr(r->unis[i].uniName, '\0', sizeof(r->unis[i].uniName)) == NULL ||
+            memchr(r->unis[i].address, '\0', sizeof(r->unis[i].address)) == NULL)
+        {
+            return 0;
+        }
+    }
+
+    for (int i = 0; i < r->stuCount; i++)
+    {
+        struct Student *s = &r->stu[i];
+
+        if (s->nextInDept < EMPTY_SLOT || s->nextInDept >= r->stuCount ||
+            memchr(s->stuName, '\0', sizeof(s->stuName)) == NULL ||
+            memchr(s->dept, '\0', sizeof(s->dept)) == NULL)
+        {
+            return 0;
+        }
+    }
+
+    for (int i = 0; i < r->idCap; i++)
+    {
+        if (r->idIndex[i] == EMPTY_SLOT)
+        {
+            freeIds++;
+        }
+        else if (r->idIndex[i] < 0 || r->idIndex[i] >= r->stuCount)
+        {
+            return 0;
+        }
+    }
+
+    for (int i = 0; i < r->deptCap; i++)
+    {
+        struct DeptEntry *d = &r->depts[i];
+
+        if (d->head == EMPTY_SLOT)
+        {
+            freeDepts++;
+            continue;
+        }
+        if (d->head < 0 || d->head >= r->stuCount || d->count < 0 ||
+            memchr(d->dept, '\0', sizeof(d->dept)) == NULL)
+        {
+            return 0;
+        }
+        usedDepts++;
+
+        // Every student is in one list, so all lists together are at most
+        // stuCount long; a longer walk means a cycle
+        for (int s = d->head; s != EMPTY_SLOT; s = r->stu[s].nextInDept)
+        {
+            if (++listed > r->stuCount)
+            {
+                return 0;
+            }
+        }
+    }
+
+    return freeIds > 0 && freeDepts > 0 && usedDepts == r->deptCount;
 }
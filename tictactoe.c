@@ -0,0 +1,1885 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdint.h>
+#include <math.h>
+
+// GCC and Clang on x86 can build AVX2/SSE4.1 functions into a baseline
+// binary and pick one at run time
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ROLLOUT_DISPATCH
+#endif
+
+#if defined(__SSE__) || defined(ROLLOUT_DISPATCH)
+#include <immintrin.h>
+#endif
+
+#include "tictactoe_internal.h"
+
+// -------------------------
+// Function Prototypes
+// -------------------------
+// Engine internals the game does not use (tictactoe_internal.h has the rest)
+static void setupBoard(Game *game);
+static int generateLines(int size, int winLength, int *lineCells);
+static char cellLabel(int index);
+static void placeMove(Game *game, int move, char symbol);
+static void clearCell(Game *game, int move);
+static void buildLineIndex(Game *game);
+static void initZobrist();
+static void initTables();
+static int randomBelow(Game *game, int bound);
+
+// Bot Engine Functions
+static int heuristicMove(Game *game, char symbol);
+static int minimaxMove(Game *game, char symbol, int depth, LeafEvaluator evaluate);
+static int searchPosition(Game *game, char symbol, int depth, int alpha, int beta, int ply, LeafEvaluator evaluate);
+static int searchPosition3x3(Game *game, char symbol, int depth, int alpha, int beta, int ply, LeafEvaluator evaluate);
+static int searchPosition4x4(Game *game, char symbol, int depth, int alpha, int beta, int ply, LeafEvaluator evaluate);
+static int searchPositionQubic(Game *game, char symbol, int depth, int alpha, int beta, int ply, LeafEvaluator evaluate);
+static int lowestCell(uint64_t bits);
+static int evaluateLines(Game *game, char symbol);
+
+// Threat-Space Search Functions
+static int threatMove(Game *game, char symbol);
+static int threatSearch(Game *game, char symbol, int depth, int threes, double deadline);
+static int findWinningCells(Game *game, int side, int *found, int max);
+
+// Qubic Functions
+static int qubicHeuristicMove(Game *game, char symbol);
+static int countBits(uint64_t bits);
+
+// Position Analysis Functions
+static int loadPosition(Game *game, const char *text);
+static char sideToMove(Game *game);
+static void analyzeGame(Game *game, int depth, PositionAnalysis *result);
+static void *analyzeWorker(void *arg);
+
+// Batch Rollout Functions
+static int initRolloutBatch(RolloutBatch *batch, Game *start, int count, uint64_t seed);
+static void freeRolloutBatch(RolloutBatch *batch);
+static void initRolloutKernel();
+static void drawRolloutPicks(RolloutBatch *batch);
+static void placeRolloutPicks(RolloutBatch *batch, int side);
+static void markRolloutWins(RolloutBatch *batch, int side);
+static void stepRolloutBatch(RolloutBatch *batch, int side);
+
+// Learned Evaluation Functions
+static int evalFeatures(Game *game, int side, float *features);
+static float evalDot(const float *weights, const float *features);
+static float evalValue(EvalModel *model, Game *game, int side);
+static void defaultEvalModel(EvalModel *model, int boardSize);
+static EvalModel *evalModelFor(Game *game);
+static int learnedEvaluate(Game *game, char symbol);
+static int evalGreedyMove(EvalModel *model, Game *game, char symbol, float epsilon);
+
+// -------------------------
+// Global Variables
+// -------------------------
+// Engine configurations available to the bot and the tournament runner
+BotEngine ttt_botEngines[MAX_ENGINES] = {
+    {"Random", ENGINE_RANDOM, 0},
+    {"Heuristic", ENGINE_HEURISTIC, 0},
+    {"Minimax-2", ENGINE_MINIMAX, 2},
+    {"Minimax-4", ENGINE_MINIMAX, 4},
+    {"Threat", ENGINE_THREAT, 0},
+    {"Learned-2", ENGINE_LEARNED, 2}
+};
+int ttt_numBotEngines = 6;
+
+// Trained evaluation weights, one model per board size code
+static EvalModel evalModels[GOMOKU_BOARD + 1];
+
+// Random keys for the incremental position hash
+static uint64_t zobristKeys[2][MAX_CELLS];
+
+// Winning lines of the flat boards, fixed at compile time (bit = row * size + col)
+static const uint64_t lines3x3[8] = {
+    0x007, 0x038, 0x1C0,            // Rows
+    0x049, 0x092, 0x124,            // Columns
+    0x111, 0x054                    // Diagonals
+};
+static const uint64_t lines4x4[10] = {
+    0x000F, 0x00F0, 0x0F00, 0xF000, // Rows
+    0x1111, 0x2222, 0x4444, 0x8888, // Columns
+    0x8421, 0x1248                  // Diagonals
+};
+
+// Winning lines of the 4x4x4 cube, also fixed at compile time
+// (bit = layer * 16 + row * 4 + col): one per line of 13 directions
+static const uint64_t qubicLines[QUBIC_LINES] = {
+    // Rows in each layer
+    0x000000000000000FULL, 0x00000000000000F0ULL, 0x0000000000000F00ULL, 0x000000000000F000ULL,
+    0x00000000000F0000ULL, 0x0000000000F00000ULL, 0x000000000F000000ULL, 0x00000000F0000000ULL,
+    0x0000000F00000000ULL, 0x000000F000000000ULL, 0x00000F0000000000ULL, 0x0000F00000000000ULL,
+    0x000F000000000000ULL, 0x00F0000000000000ULL, 0x0F00000000000000ULL, 0xF000000000000000ULL,
+    // Anti-diagonals in each layer
+    0x0000000000001248ULL, 0x0000000012480000ULL, 0x0000124800000000ULL, 0x1248000000000000ULL,
+    // Columns in each layer
+    0x0000000000001111ULL, 0x0000000000002222ULL, 0x0000000000004444ULL, 0x0000000000008888ULL,
+    0x0000000011110000ULL, 0x0000000022220000ULL, 0x0000000044440000ULL, 0x0000000088880000ULL,
+    0x0000111100000000ULL, 0x0000222200000000ULL, 0x0000444400000000ULL, 0x0000888800000000ULL,
+    0x1111000000000000ULL, 0x2222000000000000ULL, 0x4444000000000000ULL, 0x8888000000000000ULL,
+    // Diagonals in each layer
+    0x0000000000008421ULL, 0x0000000084210000ULL, 0x0000842100000000ULL, 0x8421000000000000ULL,
+    // Space diagonal (-1, -1, +1)
+    0x0001002004008000ULL,
+    // Vertical diagonals (+0, -1, +1)
+    0x0001001001001000ULL, 0x0002002002002000ULL, 0x0004004004004000ULL, 0x0008008008008000ULL,
+    // Space diagonal (+1, -1, +1)
+    0x0008004002001000ULL,
+    // Vertical diagonals (-1, +0, +1)
+    0x0001000200040008ULL, 0x0010002000400080ULL, 0x0100020004000800ULL, 0x1000200040008000ULL,
+    // Pillars through the layers
+    0x0001000100010001ULL, 0x0002000200020002ULL, 0x0004000400040004ULL, 0x0008000800080008ULL,
+    0x0010001000100010ULL, 0x0020002000200020ULL, 0x0040004000400040ULL, 0x0080008000800080ULL,
+    0x0100010001000100ULL, 0x0200020002000200ULL, 0x0400040004000400ULL, 0x0800080008000800ULL,
+    0x1000100010001000ULL, 0x2000200020002000ULL, 0x4000400040004000ULL, 0x8000800080008000ULL,
+    // Vertical diagonals (+1, +0, +1)
+    0x0008000400020001ULL, 0x0080004000200010ULL, 0x0800040002000100ULL, 0x8000400020001000ULL,
+    // Space diagonal (-1, +1, +1)
+    0x1000020000400008ULL,
+    // Vertical diagonals (+0, +1, +1)
+    0x1000010000100001ULL, 0x2000020000200002ULL, 0x4000040000400004ULL, 0x8000080000800008ULL,
+    // Space diagonal (+1, +1, +1)
+    0x8000040000200001ULL
+};
+
+// Rollout kernels for this CPU, picked once by initRolloutKernel
+static int rolloutKernelId = ROLLOUT_SCALAR;
+static int rolloutHasPdep = 0; // BMI2 PDEP finds a lane's n-th empty cell in one step
+
+// The tables above are built exactly once, by whichever thread gets there first
+#ifdef _WIN32
+static INIT_ONCE tablesOnce = INIT_ONCE_STATIC_INIT;
+#else
+static pthread_once_t tablesOnce = PTHREAD_ONCE_INIT;
+#endif
+
+// One win check per board size; the line count is a constant in each, so
+// the compiler fully unrolls the flat-board versions
+#define DEFINE_WIN_CHECK(name, table, count)                      \
+    static int name(uint64_t bits) {                              \
+        for (int i = 0; i < (count); i++) {                       \
+            if ((bits & (table)[i]) == (table)[i]) return 1;      \
+        }                                                         \
+        return 0;                                                 \
+    }
+
+DEFINE_WIN_CHECK(hasLine3x3, lines3x3, 8)
+DEFINE_WIN_CHECK(hasLine4x4, lines4x4, 10)
+
+// Qubic has too many lines to test one by one. Every line runs from a start
+// cell c in one of 13 directions (cell step d) and is full when c, c + d,
+// c + 2d and c + 3d are all set, so one shift chain per direction tests all
+// of its lines at once. The start masks keep the chains from wrapping.
+static uint64_t qubicDirection(uint64_t bits, int d, uint64_t starts) {
+    uint64_t pairs = bits & (bits >> d);
+    return pairs & (pairs >> 2 * d) & starts;
+}
+
+static int hasLineQubic(uint64_t bits) {
+    uint64_t hit = qubicDirection(bits, 1, 0x1111111111111111ULL)   // Rows
+                 | qubicDirection(bits, 4, 0x000F000F000F000FULL)   // Columns
+                 | qubicDirection(bits, 5, 0x0001000100010001ULL)   // Layer diagonals
+                 | qubicDirection(bits, 3, 0x0008000800080008ULL)   // Layer anti-diagonals
+                 | qubicDirection(bits, 16, 0x000000000000FFFFULL)  // Pillars
+                 | qubicDirection(bits, 17, 0x0000000000001111ULL)  // Vertical diagonals
+                 | qubicDirection(bits, 15, 0x0000000000008888ULL)
+                 | qubicDirection(bits, 20, 0x000000000000000FULL)
+                 | qubicDirection(bits, 12, 0x000000000000F000ULL)
+                 | qubicDirection(bits, 21, 0x0000000000000001ULL)  // Space diagonals
+                 | qubicDirection(bits, 19, 0x0000000000000008ULL)
+                 | qubicDirection(bits, 13, 0x0000000000001000ULL)
+                 | qubicDirection(bits, 11, 0x0000000000008000ULL);
+    return hit != 0;
+}
+
+// -------------------------
+// Game Core Functions
+// -------------------------
+void initializeBoard(Game *game, int size) {
+    tictactoeInit();
+
+    // Pick the line table once so checkWinner never looks at the size again
+    game->ownedLines = NULL;
+    game->lineCells = NULL;
+    if (size == GOMOKU_BOARD) {
+        initializeBoardRule(game, GOMOKU_SIZE, GOMOKU_WIN);
+        return;
+    } else if (size == QUBIC_BOARD) {
+        game->size = 4;
+        game->layers = 4;
+        game->winLines = qubicLines;
+        game->numLines = QUBIC_LINES;
+        game->hasLine = hasLineQubic;
+        game->lineLength = 4;
+    } else {
+        game->size = size;
+        game->layers = 1;
+        game->winLines = (size == 3) ? lines3x3 : lines4x4;
+        game->numLines = (size == 3) ? 8 : 10;
+        game->hasLine = (size == 3) ? hasLine3x3 : hasLine4x4;
+        game->lineLength = size;
+    }
+    setupBoard(game);
+}
+
+// Flat NxN board where winLength in a row wins; boards up to 8x8 also get
+// bitboard line masks, larger ones rely on the incremental line counters
+void initializeBoardRule(Game *game, int size, int winLength) {
+    if (winLength == size && (size == 3 || size == 4)) {
+        initializeBoard(game, size);
+        return;
+    }
+
+    int count = generateLines(size, winLength, NULL);
+    game->lineCells = (int *)malloc(count * winLength * sizeof(int));
+    generateLines(size, winLength, game->lineCells);
+
+    game->ownedLines = NULL;
+    if (size * size <= 64) {
+        game->ownedLines = (uint64_t *)malloc(count * sizeof(uint64_t));
+        for (int i = 0; i < count; i++) {
+            game->ownedLines[i] = 0;
+            for (int k = 0; k < winLength; k++) {
+                game->ownedLines[i] |= (uint64_t)1 << game->lineCells[i * winLength + k];
+            }
+        }
+    }
+
+    game->size = size;
+    game->layers = 1;
+    game->winLines = game->ownedLines;
+    game->numLines = count;
+    game->hasLine = NULL;
+    game->lineLength = winLength;
+    setupBoard(game);
+}
+
+// Every run of winLength cells along a row, column or diagonal; returns the
+// number of lines and fills lineCells (count * winLength) when it is not NULL
+static int generateLines(int size, int winLength, int *lineCells) {
+    int directions[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    int count = 0;
+
+    for (int d = 0; d < 4; d++) {
+        for (int row = 0; row < size; row++) {
+            for (int col = 0; col < size; col++) {
+                int endRow = row + (winLength - 1) * directions[d][0];
+                int endCol = col + (winLength - 1) * directions[d][1];
+                if (endRow >= size || endCol < 0 || endCol >= size) continue;
+
+                if (lineCells != NULL) {
+                    for (int k = 0; k < winLength; k++) {
+                        lineCells[count * winLength + k] =
+                            (row + k * directions[d][0]) * size + col + k * directions[d][1];
+                    }
+                }
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+static void setupBoard(Game *game) {
+    game->cells = game->size * game->size * game->layers;
+    game->moves = 0;
+    game->status = 0;
+    game->bits[0] = 0;
+    game->bits[1] = 0;
+    game->hash = 0;
+    game->historyTop = 0;
+    game->historyEnd = 0;
+    game->board = (char *)malloc(game->cells * sizeof(char));
+    game->history = (UndoEntry *)malloc(game->cells * sizeof(UndoEntry));
+
+    // Initialize with position numbers (1, 2, 3, ...)
+    for (int i = 0; i < game->cells; i++) {
+        game->board[i] = cellLabel(i);
+    }
+
+    tictactoeInit();
+    buildLineIndex(game);
+    seedGame(game, 0);
+}
+
+// Every board carries its own random state, so engines on different threads
+// never share one and a given seed always replays the same game
+void seedGame(Game *game, uint64_t seed) {
+    // SplitMix64 spreads nearby seeds; xorshift needs a non-zero state
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    game->rng = (z ^ (z >> 31)) | 1;
+}
+
+// xorshift64* draw in [0, bound)
+static int randomBelow(Game *game, int bound) {
+    uint64_t s = game->rng;
+
+    s ^= s >> 12;
+    s ^= s << 25;
+    s ^= s >> 27;
+    game->rng = s;
+    return (int)(((s * 0x2545F4914F6CDD1DULL) >> 32) % (uint64_t)bound);
+}
+
+// Lists the winning lines through every cell so a move only touches its own lines
+static void buildLineIndex(Game *game) {
+    int length = game->lineLength;
+    int total = game->numLines * length;
+
+    // Boards with fixed mask tables get their cell lists from the masks
+    if (game->lineCells == NULL) {
+        game->lineCells = (int *)malloc(total * sizeof(int));
+        for (int i = 0; i < game->numLines; i++) {
+            int k = 0;
+            for (int cell = 0; cell < game->cells; cell++) {
+                if (game->winLines[i] & ((uint64_t)1 << cell)) game->lineCells[i * length + k++] = cell;
+            }
+        }
+    }
+
+    game->lineCount = (int *)calloc(game->numLines * 2, sizeof(int));
+    game->cellLineStart = (int *)calloc(game->cells + 1, sizeof(int));
+    game->cellLines = (int *)malloc(total * sizeof(int));
+
+    // Count lines per cell, turn the counts into offsets, then fill
+    for (int i = 0; i < total; i++) {
+        game->cellLineStart[game->lineCells[i] + 1]++;
+    }
+    for (int cell = 0; cell < game->cells; cell++) {
+        game->cellLineStart[cell + 1] += game->cellLineStart[cell];
+    }
+    int *next = (int *)malloc(game->cells * sizeof(int));
+    memcpy(next, game->cellLineStart, game->cells * sizeof(int));
+    for (int i = 0; i < total; i++) {
+        game->cellLines[next[game->lineCells[i]]++] = i / length;
+    }
+    free(next);
+
+    // Every line starts out open to both sides with no stones on it
+    memset(game->patternCount, 0, sizeof(game->patternCount));
+    game->patternCount[0][0] = game->numLines;
+    game->patternCount[1][0] = game->numLines;
+}
+
+static void initZobrist() {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+
+    // SplitMix64 keeps the keys identical from run to run
+    for (int side = 0; side < 2; side++) {
+        for (int cell = 0; cell < MAX_CELLS; cell++) {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            zobristKeys[side][cell] = z ^ (z >> 31);
+        }
+    }
+}
+
+// No file is read here; tictactoeLoadWeights replaces the default models
+static void initTables() {
+    initZobrist();
+    initRolloutKernel();
+    for (int size = 3; size <= GOMOKU_BOARD; size++) {
+        defaultEvalModel(&evalModels[size], size);
+    }
+}
+
+#ifdef _WIN32
+static BOOL CALLBACK initTablesOnce(PINIT_ONCE once, PVOID param, PVOID *context) {
+    (void)once;
+    (void)param;
+    (void)context;
+    initTables();
+    return TRUE;
+}
+#endif
+
+void tictactoeInit() {
+#ifdef _WIN32
+    InitOnceExecuteOnce(&tablesOnce, initTablesOnce, NULL, NULL);
+#else
+    pthread_once(&tablesOnce, initTables);
+#endif
+}
+
+static char cellLabel(int index) {
+    if (index < 9) {
+        return '1' + index;
+    }
+    if (index < 16) {
+        return 'A' + (index - 9); // Alphabets represent Hexadecimal Values
+    }
+    return '.'; // Larger boards show their numbers when printed
+}
+
+const char *boardSizeName(int boardSize) {
+    switch (boardSize) {
+        case 3: return "3x3";
+        case 4: return "4x4";
+        case QUBIC_BOARD: return "4x4x4";
+        case GOMOKU_BOARD: return "15x15";
+        default: return "?";
+    }
+}
+
+int checkWinner(Game *game, char symbol) {
+    uint64_t own = game->bits[(symbol == 'X') ? 0 : 1];
+
+    if (game->hasLine != NULL) {
+        return game->hasLine(own);
+    }
+    if (game->winLines != NULL) {
+        for (int i = 0; i < game->numLines; i++) {
+            if ((own & game->winLines[i]) == game->winLines[i]) return 1;
+        }
+        return 0;
+    }
+
+    // Boards too large for bitboards: a full line shows up in the counters
+    return game->patternCount[(symbol == 'X') ? 0 : 1][game->lineLength] > 0;
+}
+
+// Reference scan over the char board, kept for the win-check benchmark:
+// rows, columns and diagonals on flat boards, every line's cells on Qubic
+int checkWinnerScan(Game *game, char symbol) {
+    int size = game->size;
+
+    if (game->layers > 1) {
+        for (int i = 0; i < game->numLines; i++) {
+            int count = 0;
+            for (int k = 0; k < game->lineLength; k++) {
+                if (game->board[game->lineCells[i * game->lineLength + k]] == symbol)
+                    count++;
+            }
+            if (count == game->lineLength) return 1;
+        }
+        return 0;
+    }
+
+    // Check rows
+    for (int i = 0; i < size; i++) {
+        int count = 0;
+        for (int j = 0; j < size; j++) {
+            if (game->board[i * size + j] == symbol)
+                count++;
+        }
+        if (count == size) return 1;
+    }
+
+    // Check columns
+    for (int j = 0; j < size; j++) {
+        int count = 0;
+        for (int i = 0; i < size; i++) {
+            if (game->board[i * size + j] == symbol)
+                count++;
+        }
+        if (count == size) return 1;
+    }
+
+    // Check main diagonal
+    int count = 0;
+    for (int i = 0; i < size; i++) {
+        if (game->board[i * size + i] == symbol)
+            count++;
+    }
+    if (count == size) return 1;
+
+    // Check anti-diagonal
+    count = 0;
+    for (int i = 0; i < size; i++) {
+        if (game->board[i * size + (size - 1 - i)] == symbol)
+            count++;
+    }
+    if (count == size) return 1;
+
+    return 0;
+}
+
+int isDraw(Game *game) {
+    return (game->moves == game->cells);
+}
+
+void freeBoard(Game *game) {
+    free(game->board);
+    free(game->history);
+    free(game->lineCount);
+    free(game->cellLineStart);
+    free(game->cellLines);
+    free(game->ownedLines);
+    free(game->lineCells);
+    game->board = NULL;
+    game->ownedLines = NULL;
+    game->lineCells = NULL;
+    game->history = NULL;
+    game->lineCount = NULL;
+    game->cellLineStart = NULL;
+    game->cellLines = NULL;
+}
+
+int isValidMove(Game *game, int move) {
+    int maxPos = game->cells;
+    if (move < 1 || move > maxPos) return 0;
+
+    char pos = game->board[move - 1];
+    return (pos != 'X' && pos != 'O');
+}
+
+static void placeMove(Game *game, int move, char symbol) {
+    game->board[move - 1] = symbol;
+    if (game->cells <= 64) {
+        game->bits[(symbol == 'X') ? 0 : 1] |= (uint64_t)1 << (move - 1);
+    }
+    game->moves++;
+}
+
+static void clearCell(Game *game, int move) {
+    game->board[move - 1] = cellLabel(move - 1);
+    if (game->cells <= 64) {
+        uint64_t bit = (uint64_t)1 << (move - 1);
+        game->bits[0] &= ~bit;
+        game->bits[1] &= ~bit;
+    }
+    game->moves--;
+}
+
+// -------------------------
+// Make/Unmake Functions
+// -------------------------
+void makeMove(Game *game, int move, char symbol) {
+    int cell = move - 1;
+    int side = (symbol == 'X') ? 0 : 1;
+    UndoEntry *entry = &game->history[game->historyTop++];
+
+    entry->cell = cell;
+    entry->symbol = symbol;
+    entry->prevHash = game->hash;
+    game->historyEnd = game->historyTop; // A new move discards the redo list
+
+    placeMove(game, move, symbol);
+    game->hash ^= zobristKeys[side][cell];
+    for (int i = game->cellLineStart[cell]; i < game->cellLineStart[cell + 1]; i++) {
+        int *count = &game->lineCount[game->cellLines[i] * 2];
+        int own = count[side];
+        int opp = count[1 - side];
+
+        // The line moves up one pattern for this side and closes for the other
+        if (opp == 0) {
+            game->patternCount[side][own]--;
+            game->patternCount[side][own + 1]++;
+        }
+        if (own == 0) game->patternCount[1 - side][opp]--;
+        count[side]++;
+    }
+}
+
+void unmakeMove(Game *game) {
+    UndoEntry *entry = &game->history[--game->historyTop];
+    int cell = entry->cell;
+    int side = (entry->symbol == 'X') ? 0 : 1;
+
+    clearCell(game, cell + 1);
+    game->hash = entry->prevHash;
+    for (int i = game->cellLineStart[cell]; i < game->cellLineStart[cell + 1]; i++) {
+        int *count = &game->lineCount[game->cellLines[i] * 2];
+        int own = --count[side];
+        int opp = count[1 - side];
+
+        if (opp == 0) {
+            game->patternCount[side][own + 1]--;
+            game->patternCount[side][own]++;
+        }
+        if (own == 0) game->patternCount[1 - side][opp]++;
+    }
+}
+
+int undoMoves(Game *game, int count) {
+    if (game->historyTop < count) return 0;
+
+    for (int i = 0; i < count; i++) {
+        unmakeMove(game);
+    }
+    return 1;
+}
+
+int redoMoves(Game *game, int count) {
+    int redoEnd = game->historyEnd;
+
+    if (redoEnd - game->historyTop < count) return 0;
+
+    for (int i = 0; i < count; i++) {
+        UndoEntry *entry = &game->history[game->historyTop];
+        makeMove(game, entry->cell + 1, entry->symbol);
+    }
+    game->historyEnd = redoEnd;
+    return 1;
+}
+
+// Checks only the lines through the most recent move
+int lastMoveWins(Game *game) {
+    UndoEntry *entry = &game->history[game->historyTop - 1];
+    int side = (entry->symbol == 'X') ? 0 : 1;
+
+    for (int i = game->cellLineStart[entry->cell]; i < game->cellLineStart[entry->cell + 1]; i++) {
+        if (game->lineCount[game->cellLines[i] * 2 + side] == game->lineLength) return 1;
+    }
+    return 0;
+}
+
+// -------------------------
+// Bot Engine Functions
+// -------------------------
+int randomMove(Game *game) {
+    int move;
+    int maxPos = game->cells;
+
+    do {
+        move = randomBelow(game, maxPos) + 1;
+    } while (!isValidMove(game, move));
+
+    return move;
+}
+
+static int heuristicMove(Game *game, char symbol) {
+    char opponent = (symbol == 'X') ? 'O' : 'X';
+    int maxPos = game->cells;
+    int size = game->size;
+
+    // Take a winning move first, otherwise block the opponent's
+    char tryOrder[2] = {symbol, opponent};
+    for (int t = 0; t < 2; t++) {
+        for (int move = 1; move <= maxPos; move++) {
+            if (!isValidMove(game, move)) continue;
+
+            makeMove(game, move, tryOrder[t]);
+            int wins = lastMoveWins(game);
+            unmakeMove(game);
+
+            if (wins) return move;
+        }
+    }
+
+    if (game->layers > 1) {
+        return qubicHeuristicMove(game, symbol);
+    }
+
+    // Prefer the centre cells, then the corners
+    int mid = size / 2;
+    int centre[4] = {mid * size + mid, (mid - 1) * size + mid - 1,
+                     (mid - 1) * size + mid, mid * size + mid - 1};
+    int centreCount = (size % 2 == 1) ? 1 : 4;
+    for (int i = 0; i < centreCount; i++) {
+        if (isValidMove(game, centre[i] + 1)) return centre[i] + 1;
+    }
+
+    int corners[4] = {0, size - 1, (size - 1) * size, size * size - 1};
+    for (int i = 0; i < 4; i++) {
+        if (isValidMove(game, corners[i] + 1)) return corners[i] + 1;
+    }
+
+    return randomMove(game);
+}
+
+// First configured engine of the given type
+BotEngine *findEngine(int type) {
+    for (int i = 0; i < ttt_numBotEngines; i++) {
+        if (ttt_botEngines[i].type == type) return &ttt_botEngines[i];
+    }
+    return &ttt_botEngines[0];
+}
+
+int chooseEngineMove(Game *game, char symbol, BotEngine *engine) {
+    int depth = engine->depth;
+
+    // A 4-ply search over 225 cells takes close to a minute per game
+    if (game->cells > 64 && depth > GOMOKU_MAX_DEPTH) depth = GOMOKU_MAX_DEPTH;
+
+    switch (engine->type) {
+        case ENGINE_HEURISTIC:
+            return heuristicMove(game, symbol);
+        case ENGINE_MINIMAX:
+            return minimaxMove(game, symbol, depth, evaluateLines);
+        case ENGINE_THREAT:
+            return threatMove(game, symbol);
+        case ENGINE_LEARNED:
+            // Same search as Minimax, with the trained weights at the leaves
+            return minimaxMove(game, symbol, depth, learnedEvaluate);
+        case ENGINE_RANDOM:
+        default:
+            return randomMove(game);
+    }
+}
+
+static int minimaxMove(Game *game, char symbol, int depth, LeafEvaluator evaluate) {
+    char opponent = (symbol == 'X') ? 'O' : 'X';
+    int bestScore = -WIN_SCORE - 1;
+    int bestMove = 0;
+    int ties = 0;
+
+    // Gomoku: open in the centre, then only look near the stones
+    if (game->cells > 64 && game->moves == 0) {
+        return (game->size / 2) * game->size + game->size / 2 + 1;
+    }
+
+    for (int move = 1; move <= game->cells; move++) {
+        if (!isValidMove(game, move) || !isNearStone(game, move - 1)) continue;
+
+        int score;
+        makeMove(game, move, symbol);
+        if (lastMoveWins(game)) {
+            score = WIN_SCORE;
+        } else if (isDraw(game)) {
+            score = 0;
+        } else if (depth <= 1) {
+            score = evaluate(game, symbol);
+        } else {
+            score = -searchPosition(game, opponent, depth - 1, -WIN_SCORE - 1, -bestScore + 1, 1, evaluate);
+        }
+        unmakeMove(game);
+
+        // Pick uniformly among equally good moves so games between engines vary
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+            ties = 1;
+        } else if (score == bestScore && randomBelow(game, ++ties) == 0) {
+            bestMove = move;
+        }
+    }
+
+    return bestMove;
+}
+
+// Negamax with alpha-beta pruning; the board is updated in place with
+// makeMove/unmakeMove so no node copies the position. The standard boards
+// go to a search specialized for their size; custom rules and Gomoku use
+// the generic loop below.
+static int searchPosition(Game *game, char symbol, int depth, int alpha, int beta, int ply, LeafEvaluator evaluate) {
+    char opponent = (symbol == 'X') ? 'O' : 'X';
+    int best = -WIN_SCORE - 1;
+
+    if (game->hasLine == hasLine3x3) return searchPosition3x3(game, symbol, depth, alpha, beta, ply, evaluate);
+    if (game->hasLine == hasLine4x4) return searchPosition4x4(game, symbol, depth, alpha, beta, ply, evaluate);
+    if (game->hasLine == hasLineQubic) return searchPositionQubic(game, symbol, depth, alpha, beta, ply, evaluate);
+
+    for (int move = 1; move <= game->cells; move++) {
+        if (!isValidMove(game, move) || !isNearStone(game, move - 1)) continue;
+
+        int score;
+        makeMove(game, move, symbol);
+        if (lastMoveWins(game)) {
+            score = WIN_SCORE - ply; // Prefer faster wins
+        } else if (isDraw(game)) {
+            score = 0;
+        } else if (depth <= 1) {
+            score = evaluate(game, symbol);
+        } else {
+            score = -searchPosition(game, opponent, depth - 1, -beta, -alpha, ply + 1, evaluate);
+        }
+        unmakeMove(game);
+
+        if (score > best) best = score;
+        if (best > alpha) alpha = best;
+        if (alpha >= beta) break;
+    }
+
+    return best;
+}
+
+// One search per standard board, like the win checks: the cell count is a
+// constant, moves come straight off the empty-cell bitboard in cell order
+// (so the results match the generic loop) and a move wins when the board's
+// own unrolled line check says so. Only the leaf evaluator stays a call.
+#define DEFINE_SEARCH(name, cells, hasLine)                                                       \
+    static int name(Game *game, char symbol, int depth, int alpha, int beta, int ply,              \
+                    LeafEvaluator evaluate) {                                                      \
+        char opponent = (symbol == 'X') ? 'O' : 'X';                                               \
+        int side = (symbol == 'X') ? 0 : 1;                                                        \
+        uint64_t full = ((cells) == 64) ? ~(uint64_t)0 : ((uint64_t)1 << (cells)) - 1;             \
+        uint64_t empty = ~(game->bits[0] | game->bits[1]) & full;                                  \
+        int best = -WIN_SCORE - 1;                                                                 \
+                                                                                                   \
+        while (empty != 0) {                                                                       \
+            int move = lowestCell(empty) + 1;                                                      \
+            int score;                                                                             \
+            empty &= empty - 1;                                                                    \
+                                                                                                   \
+            makeMove(game, move, symbol);                                                          \
+            if (hasLine(game->bits[side])) {                                                      \
+                score = WIN_SCORE - ply;                                                           \
+            } else if (game->moves == (cells)) {                                                   \
+                score = 0;                                                                         \
+            } else if (depth <= 1) {                                                               \
+                score = evaluate(game, symbol);                                                    \
+            } else {                                                                               \
+                score = -name(game, opponent, depth - 1, -beta, -alpha, ply + 1, evaluate);        \
+            }                                                                                      \
+            unmakeMove(game);                                                                      \
+                                                                                                   \
+            if (score > best) best = score;                                                        \
+            if (best > alpha) alpha = best;                                                        \
+            if (alpha >= beta) break;                                                              \
+        }                                                                                          \
+                                                                                                   \
+        return best;                                                                               \
+    }
+
+DEFINE_SEARCH(searchPosition3x3, 9, hasLine3x3)
+DEFINE_SEARCH(searchPosition4x4, 16, hasLine4x4)
+DEFINE_SEARCH(searchPositionQubic, 64, hasLineQubic)
+
+// Index of the lowest set bit (bits must not be 0)
+static int lowestCell(uint64_t bits) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(bits);
+#else
+    int cell = 0;
+    while (!(bits & 1)) {
+        bits >>= 1;
+        cell++;
+    }
+    return cell;
+#endif
+}
+
+// Static score from symbol's point of view: lines still open to one side
+// count for that side, weighted by how many stones they already hold. The
+// incremental pattern counters already hold those lines by stone count, so
+// this costs a few steps on every board instead of a pass over all lines.
+static int evaluateLines(Game *game, char symbol) {
+    int side = (symbol == 'X') ? 0 : 1;
+    int weights[5] = {0, 1, 8, 64, 512};
+    int score = 0;
+
+    for (int k = 1; k <= game->lineLength && k < 5; k++) {
+        score += weights[k] * (game->patternCount[side][k] - game->patternCount[1 - side][k]);
+    }
+
+    return score;
+}
+
+// -------------------------
+// Threat-Space Search Functions
+// -------------------------
+// Plays immediate wins and blocks, then looks for a forced win made only of
+// threats (fours, then fours and threes), then defends against the
+// opponent's forced win, and otherwise picks the move with the best
+// incremental pattern score. Search stops after THREAT_BUDGET_MS.
+static int threatMove(Game *game, char symbol) {
+    int side = (symbol == 'X') ? 0 : 1;
+    char opponent = (symbol == 'X') ? 'O' : 'X';
+    double deadline = ttt_wallSeconds() + THREAT_BUDGET_MS / 1000.0;
+    int found[2];
+    int move;
+
+    if (game->moves == 0) {
+        return (game->size / 2) * game->size + game->size / 2 + 1;
+    }
+    if (findWinningCells(game, side, found, 1)) return found[0] + 1;
+    if (findWinningCells(game, 1 - side, found, 1)) return found[0] + 1;
+
+    if ((move = threatSearch(game, symbol, 12, 0, deadline)) != 0) return move;
+    if ((move = threatSearch(game, symbol, 6, 2, deadline)) != 0) return move;
+
+    // Occupy the first square of the opponent's forced win
+    if ((move = threatSearch(game, opponent, 12, 0, deadline)) != 0) return move;
+
+    int bestScore = 0;
+    int bestMove = 0;
+    for (int cell = 0; cell < game->cells; cell++) {
+        if (!isValidMove(game, cell + 1) || !isNearStone(game, cell)) continue;
+
+        makeMove(game, cell + 1, symbol);
+        int score = patternScore(game, side) - patternScore(game, 1 - side) * 5 / 4;
+        unmakeMove(game);
+
+        if (bestMove == 0 || score > bestScore || (score == bestScore && randomBelow(game, 2) == 0)) {
+            bestScore = score;
+            bestMove = cell + 1;
+        }
+    }
+
+    return (bestMove != 0) ? bestMove : randomMove(game);
+}
+
+// Returns a first move that wins by a sequence of threats, or 0. Fours leave
+// the defender a single reply; threes (at most `threes` of them) are tried
+// against every defence and counter-four.
+static int threatSearch(Game *game, char symbol, int depth, int threes, double deadline) {
+    int side = (symbol == 'X') ? 0 : 1;
+    char opponent = (symbol == 'X') ? 'O' : 'X';
+    int length = game->lineLength;
+    int found[2];
+    int candidates[MAX_CELLS];
+    char marked[MAX_CELLS];
+    int count = 0;
+
+    if (findWinningCells(game, side, found, 1)) return found[0] + 1;
+    if (depth == 0 || ttt_wallSeconds() > deadline) return 0;
+
+    // A defender four must be blocked; the block only helps if it is a threat too
+    int defenderWins = findWinningCells(game, 1 - side, found, 2);
+    if (defenderWins >= 2) return 0;
+
+    memset(marked, 0, game->cells);
+    if (defenderWins == 1) {
+        candidates[count++] = found[0];
+    } else {
+        int minStones = (threes > 0 && length >= 5) ? length - 3 : length - 2;
+        for (int i = 0; i < game->numLines; i++) {
+            int own = game->lineCount[i * 2 + side];
+            if (game->lineCount[i * 2 + 1 - side] != 0 || own < minStones || own > length - 2) continue;
+            for (int k = 0; k < length; k++) {
+                int cell = game->lineCells[i * length + k];
+                if (!marked[cell] && isValidMove(game, cell + 1)) {
+                    marked[cell] = 1;
+                    candidates[count++] = cell;
+                }
+            }
+        }
+    }
+
+    for (int c = 0; c < count; c++) {
+        int move = candidates[c] + 1;
+        int result = 0;
+
+        makeMove(game, move, symbol);
+        int threats = findWinningCells(game, side, found, 2);
+
+        if (threats >= 2) {
+            result = 1; // Two ways to win; only one can be blocked
+        } else if (threats == 1) {
+            makeMove(game, found[0] + 1, opponent);
+            result = !lastMoveWins(game) && threatSearch(game, symbol, depth - 1, threes, deadline);
+            unmakeMove(game);
+        } else if (threes > 0 && length >= 5) {
+            // Defender may block any cell of the new threes or make a four
+            int defences[MAX_CELLS];
+            char seen[MAX_CELLS];
+            int defenceCount = 0;
+            memset(seen, 0, game->cells);
+
+            for (int i = game->cellLineStart[move - 1]; i < game->cellLineStart[move]; i++) {
+                int line = game->cellLines[i];
+                if (game->lineCount[line * 2 + side] != length - 2 || game->lineCount[line * 2 + 1 - side] != 0) continue;
+                for (int k = 0; k < length; k++) {
+                    int cell = game->lineCells[line * length + k];
+                    if (!seen[cell] && isValidMove(game, cell + 1)) {
+                        seen[cell] = 1;
+                        defences[defenceCount++] = cell;
+                    }
+                }
+            }
+            for (int i = 0; i < game->numLines && defenceCount > 0; i++) {
+                if (game->lineCount[i * 2 + 1 - side] != length - 2 || game->lineCount[i * 2 + side] != 0) continue;
+                for (int k = 0; k < length; k++) {
+                    int cell = game->lineCells[i * length + k];
+                    if (!seen[cell] && isValidMove(game, cell + 1)) {
+                        seen[cell] = 1;
+                        defences[defenceCount++] = cell;
+                    }
+                }
+            }
+
+            result = (defenceCount > 0);
+            for (int d = 0; d < defenceCount && result; d++) {
+                makeMove(game, defences[d] + 1, opponent);
+                result = !lastMoveWins(game) && threatSearch(game, symbol, depth - 1, threes - 1, deadline);
+                unmakeMove(game);
+            }
+        }
+        unmakeMove(game);
+
+        if (result) return move;
+        if (ttt_wallSeconds() > deadline) break;
+    }
+
+    return 0;
+}
+
+// Collects up to max distinct cells where side completes a line right now
+static int findWinningCells(Game *game, int side, int *found, int max) {
+    int length = game->lineLength;
+    int count = 0;
+
+    if (game->patternCount[side][length - 1] == 0) return 0;
+
+    for (int i = 0; i < game->numLines && count < max; i++) {
+        if (game->lineCount[i * 2 + side] != length - 1 || game->lineCount[i * 2 + 1 - side] != 0) continue;
+        for (int k = 0; k < length; k++) {
+            int cell = game->lineCells[i * length + k];
+            if (isValidMove(game, cell + 1) && (count == 0 || found[0] != cell)) {
+                found[count++] = cell;
+                break;
+            }
+        }
+    }
+
+    return count;
+}
+
+// Weighted sum of the lines still open to side, from the incremental counters
+int patternScore(Game *game, int side) {
+    int weights[8] = {0, 1, 12, 150, 2000, 30000, 400000, 5000000};
+    int score = 0;
+
+    int offset = (game->lineLength < 5) ? 5 - game->lineLength : 0;
+
+    for (int n = 1; n < game->lineLength; n++) {
+        score += game->patternCount[side][n] * weights[n + offset];
+    }
+    return score;
+}
+
+// On large boards only cells within two steps of a stone are worth trying
+int isNearStone(Game *game, int cell) {
+    int size = game->size;
+    int row = cell / size;
+    int col = cell % size;
+
+    if (game->cells <= 64) return 1;
+
+    for (int r = row - 2; r <= row + 2; r++) {
+        for (int c = col - 2; c <= col + 2; c++) {
+            if (r < 0 || r >= size || c < 0 || c >= size) continue;
+            char pos = game->board[r * size + c];
+            if (pos == 'X' || pos == 'O') return 1;
+        }
+    }
+    return 0;
+}
+
+// -------------------------
+// Qubic (4x4x4) Functions
+// -------------------------
+static int countBits(uint64_t bits) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(bits);
+#else
+    int count = 0;
+    while (bits) {
+        bits &= bits - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+static int qubicHeuristicMove(Game *game, char symbol) {
+    int side = (symbol == 'X') ? 0 : 1;
+    uint64_t own = game->bits[side];
+    uint64_t opp = game->bits[1 - side];
+    // Weights by number of stones already on an otherwise clear line
+    int attack[4] = {1, 4, 32, 0};
+    int defend[4] = {1, 3, 24, 0};
+    int bestScore = -1;
+    int bestMove = 0;
+
+    for (int cell = 0; cell < 64; cell++) {
+        uint64_t bit = (uint64_t)1 << cell;
+        if ((own | opp) & bit) continue;
+
+        int score = 0;
+        for (int i = 0; i < game->numLines; i++) {
+            uint64_t line = game->winLines[i];
+            if (!(line & bit)) continue;
+            if (!(line & opp)) score += attack[countBits(line & own)];
+            if (!(line & own)) score += defend[countBits(line & opp)];
+        }
+
+        // Break ties randomly so the bot does not always play the same game
+        if (score > bestScore || (score == bestScore && randomBelow(game, 2) == 0)) {
+            bestScore = score;
+            bestMove = cell + 1;
+        }
+    }
+
+    return bestMove;
+}
+
+// -------------------------
+// Position Analysis Functions
+// -------------------------
+// X moves whenever both sides have placed the same number of stones
+static char sideToMove(Game *game) {
+    int xCount = countBits(game->bits[0]);
+
+    // Bitboards only cover boards up to 64 cells
+    if (game->cells > 64) {
+        xCount = 0;
+        for (int i = 0; i < game->cells; i++) {
+            if (game->board[i] == 'X') xCount++;
+        }
+    }
+
+    return (xCount * 2 == game->moves) ? 'X' : 'O';
+}
+
+// Positions are plain strings: 'X' and 'O' are stones, '.' or '-' an empty
+// cell, anything else (spaces, '|', '/') is layout and skipped. The number of
+// cells picks the board: 9 = 3x3, 16 = 4x4, 64 = Qubic, 225 = Gomoku.
+int positionBoardSize(const char *text) {
+    int cells = 0;
+
+    for (const char *c = text; *c != '\0' && *c != '\n'; c++) {
+        if (*c == 'X' || *c == 'O' || *c == 'x' || *c == 'o' || *c == '.' || *c == '-') cells++;
+    }
+
+    switch (cells) {
+        case 9: return 3;
+        case 16: return 4;
+        case 64: return QUBIC_BOARD;
+        case 225: return GOMOKU_BOARD;
+        default: return 0;
+    }
+}
+
+// Replays the position onto a board of the right size, reusing its tables.
+// Returns 0 if the stone counts cannot come from a legal game.
+static int loadPosition(Game *game, const char *text) {
+    int cell = 0;
+    int xCount = 0;
+    int oCount = 0;
+
+    undoMoves(game, game->historyTop);
+    game->status = 0;
+
+    for (const char *c = text; *c != '\0' && *c != '\n' && cell < game->cells; c++) {
+        if (*c == 'X' || *c == 'x') {
+            makeMove(game, ++cell, 'X');
+            xCount++;
+        } else if (*c == 'O' || *c == 'o') {
+            makeMove(game, ++cell, 'O');
+            oCount++;
+        } else if (*c == '.' || *c == '-') {
+            cell++;
+        }
+    }
+
+    return (cell == game->cells && (xCount == oCount || xCount == oCount + 1));
+}
+
+// Root search from the side to move. Flat boards and Qubic use the negamax
+// search and are solved exactly once the depth covers every empty cell or a
+// forced result shows up; Gomoku uses the threat engine's win detection.
+static void analyzeGame(Game *game, int depth, PositionAnalysis *result) {
+    char symbol = sideToMove(game);
+    char opponent = (symbol == 'X') ? 'O' : 'X';
+
+    // Ties in the threat engine are broken from the position itself, so
+    // every run and every thread gives the same answer
+    seedGame(game, game->hash);
+    result->toMove = symbol;
+    result->bestMove = 0;
+    result->score = 0;
+    result->value = 0;
+    result->solved = 1;
+
+    if (checkWinner(game, opponent) || checkWinner(game, symbol)) {
+        result->status = 1;
+        result->value = checkWinner(game, symbol) ? 1 : -1;
+        result->score = result->value * WIN_SCORE;
+        return;
+    }
+    if (isDraw(game)) {
+        result->status = 2;
+        return;
+    }
+    result->status = 0;
+
+    if (game->cells > 64) {
+        int side = (symbol == 'X') ? 0 : 1;
+        int found[1];
+
+        result->bestMove = threatMove(game, symbol);
+        if (findWinningCells(game, side, found, 1)) {
+            result->value = 1;
+            result->score = WIN_SCORE;
+        } else {
+            result->solved = 0;
+            result->score = patternScore(game, side) - patternScore(game, 1 - side);
+        }
+        return;
+    }
+
+    // Same scoring as minimaxMove, but ties keep the lowest cell so the
+    // analysis of a position never changes between runs
+    int best = -WIN_SCORE - 1;
+    for (int move = 1; move <= game->cells; move++) {
+        if (!isValidMove(game, move)) continue;
+
+        int score;
+        makeMove(game, move, symbol);
+        if (lastMoveWins(game)) {
+            score = WIN_SCORE;
+        } else if (isDraw(game)) {
+            score = 0;
+        } else if (depth <= 1) {
+            score = evaluateLines(game, symbol);
+        } else {
+            score = -searchPosition(game, opponent, depth - 1, -WIN_SCORE - 1, -best + 1, 1, evaluateLines);
+        }
+        unmakeMove(game);
+
+        if (score > best) {
+            best = score;
+            result->bestMove = move;
+        }
+    }
+
+    result->score = best;
+    if (best >= WIN_SCORE - game->cells) {
+        result->value = 1;
+    } else if (best <= -WIN_SCORE + game->cells) {
+        result->value = -1;
+    } else if (depth < game->cells - game->moves) {
+        result->solved = 0; // The search stopped at heuristic leaves
+    }
+}
+
+// Deepest search that keeps an early-game position to a few milliseconds on
+// one core (3x3 is solved outright); later positions are usually solved
+int defaultAnalysisDepth(int boardSize) {
+    switch (boardSize) {
+        case 3: return 9;
+        case 4: return 5;
+        case QUBIC_BOARD: return 3;
+        default: return 1; // Gomoku uses the threat engine, which has its own budget
+    }
+}
+
+void analyzePosition(const char *text, int depth, PositionAnalysis *result) {
+    analyzePositions(&text, 1, depth, 1, result);
+}
+
+// Claims ANALYZE_CLAIM positions at a time until the batch runs out. Each
+// worker keeps one board per size, so the line tables and index are not
+// rebuilt for every position.
+static void *analyzeWorker(void *arg) {
+    AnalyzeBatch *batch = (AnalyzeBatch *)arg;
+    Game boards[GOMOKU_BOARD + 1];
+    int ready[GOMOKU_BOARD + 1] = {0};
+    int analyzed = 0;
+
+    for (;;) {
+        ttt_mutexLock(&batch->lock);
+        int first = batch->next;
+        batch->next += ANALYZE_CLAIM;
+        ttt_mutexUnlock(&batch->lock);
+
+        if (first >= batch->count) break;
+        int last = (first + ANALYZE_CLAIM < batch->count) ? first + ANALYZE_CLAIM : batch->count;
+
+        for (int i = first; i < last; i++) {
+            PositionAnalysis *result = &batch->results[i];
+            int size = positionBoardSize(batch->positions[i]);
+
+            memset(result, 0, sizeof(PositionAnalysis));
+            result->boardSize = size;
+            if (size == 0) continue;
+
+            if (!ready[size]) {
+                initializeBoard(&boards[size], size);
+                ready[size] = 1;
+            }
+            if (!loadPosition(&boards[size], batch->positions[i])) {
+                result->boardSize = 0;
+                continue;
+            }
+
+            result->depth = (batch->depth > 0) ? batch->depth : defaultAnalysisDepth(size);
+            analyzeGame(&boards[size], result->depth, result);
+            analyzed++;
+        }
+    }
+
+    for (int size = 0; size <= GOMOKU_BOARD; size++) {
+        if (ready[size]) freeBoard(&boards[size]);
+    }
+
+    ttt_mutexLock(&batch->lock);
+    batch->analyzed += analyzed;
+    ttt_mutexUnlock(&batch->lock);
+    return NULL;
+}
+
+// Splits a batch of positions over the calling thread and up to threads - 1
+// helpers. Returns the number of positions that could be read.
+int analyzePositions(const char **positions, int count, int depth, int threads, PositionAnalysis *results) {
+    AnalyzeBatch batch;
+    Thread helpers[ANALYZE_MAX_THREADS];
+    int started = 0;
+
+    tictactoeInit();
+
+    batch.positions = positions;
+    batch.results = results;
+    batch.count = count;
+    batch.depth = depth;
+    batch.next = 0;
+    batch.analyzed = 0;
+    ttt_mutexInit(&batch.lock);
+
+    if (threads <= 0) threads = ttt_cpuCount();
+    if (threads > ANALYZE_MAX_THREADS) threads = ANALYZE_MAX_THREADS;
+    if (threads > (count + ANALYZE_CLAIM - 1) / ANALYZE_CLAIM) threads = (count + ANALYZE_CLAIM - 1) / ANALYZE_CLAIM;
+
+    // A helper that fails to start just leaves its share to the others
+    for (int t = 1; t < threads; t++) {
+        if (ttt_threadStart(&helpers[started], analyzeWorker, &batch)) started++;
+    }
+    analyzeWorker(&batch);
+    for (int t = 0; t < started; t++) {
+        ttt_threadJoin(helpers[t]);
+    }
+
+    ttt_mutexDestroy(&batch.lock);
+    return batch.analyzed;
+}
+
+// -------------------------
+// Batch Rollout Functions
+// -------------------------
+// A batch keeps many games side by side as struct-of-arrays bitboards (one
+// lane per game). Every lane starts from the same position, so all lanes are
+// on the same ply and only finished games have to be skipped.
+static int initRolloutBatch(RolloutBatch *batch, Game *start, int count, uint64_t seed) {
+    // Rollouts need the bitboards, which only exist up to 64 cells
+    if (start->winLines == NULL || count < 1) return 0;
+
+    batch->count = count;
+    batch->cells = start->cells;
+    batch->moves = start->moves;
+    batch->numLines = start->numLines;
+    batch->winLines = start->winLines;
+    batch->bits[0] = (uint64_t *)malloc(count * sizeof(uint64_t));
+    batch->bits[1] = (uint64_t *)malloc(count * sizeof(uint64_t));
+    batch->rng = (uint64_t *)malloc(count * sizeof(uint64_t));
+    batch->pick = (uint64_t *)malloc(count * sizeof(uint64_t));
+    batch->won = (uint64_t *)malloc(count * sizeof(uint64_t));
+    batch->status = (char *)malloc(count * sizeof(char));
+
+    if (batch->bits[0] == NULL || batch->bits[1] == NULL || batch->rng == NULL || batch->pick == NULL ||
+        batch->won == NULL || batch->status == NULL) {
+        freeRolloutBatch(batch);
+        return 0;
+    }
+
+    int result = 0;
+    if (checkWinner(start, 'X')) {
+        result = 1;
+    } else if (checkWinner(start, 'O')) {
+        result = 2;
+    } else if (isDraw(start)) {
+        result = 3;
+    }
+
+    for (int lane = 0; lane < count; lane++) {
+        // SplitMix64 spreads the seed so neighbouring lanes are unrelated
+        uint64_t z = seed + (uint64_t)(lane + 1) * 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        batch->rng[lane] = (z ^ (z >> 31)) | 1;
+
+        batch->bits[0][lane] = start->bits[0];
+        batch->bits[1][lane] = start->bits[1];
+        batch->status[lane] = (char)result;
+    }
+
+    return 1;
+}
+
+static void freeRolloutBatch(RolloutBatch *batch) {
+    free(batch->bits[0]);
+    free(batch->bits[1]);
+    free(batch->rng);
+    free(batch->pick);
+    free(batch->won);
+    free(batch->status);
+    batch->bits[0] = NULL;
+    batch->bits[1] = NULL;
+    batch->rng = NULL;
+    batch->pick = NULL;
+    batch->won = NULL;
+    batch->status = NULL;
+}
+
+#ifdef ROLLOUT_DISPATCH
+// Compares every line mask against 4 lanes at a time; returns the lanes done
+__attribute__((target("avx2")))
+static int markWinsAVX2(const uint64_t *own, uint64_t *won, int count, const uint64_t *lines, int numLines) {
+    int lane = 0;
+
+    for (; lane + 4 <= count; lane += 4) {
+        __m256i bits = _mm256_loadu_si256((const __m256i *)(own + lane));
+        __m256i hit = _mm256_setzero_si256();
+        for (int i = 0; i < numLines; i++) {
+            __m256i line = _mm256_set1_epi64x((long long)lines[i]);
+            hit = _mm256_or_si256(hit, _mm256_cmpeq_epi64(_mm256_and_si256(bits, line), line));
+        }
+        _mm256_storeu_si256((__m256i *)(won + lane), hit);
+    }
+    return lane;
+}
+
+__attribute__((target("sse4.1")))
+static int markWinsSSE41(const uint64_t *own, uint64_t *won, int count, const uint64_t *lines, int numLines) {
+    int lane = 0;
+
+    for (; lane + 2 <= count; lane += 2) {
+        __m128i bits = _mm_loadu_si128((const __m128i *)(own + lane));
+        __m128i hit = _mm_setzero_si128();
+        for (int i = 0; i < numLines; i++) {
+            __m128i line = _mm_set1_epi64x((long long)lines[i]);
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi64(_mm_and_si128(bits, line), line));
+        }
+        _mm_storeu_si128((__m128i *)(won + lane), hit);
+    }
+    return lane;
+}
+
+// Advances the xorshift64* state of 4 lanes at a time and scales each draw
+// to a rank below emptyCount, exactly as drawRolloutPicks does per lane.
+// AVX2 has no 64-bit multiply, so the middle word of s * multiplier is put
+// together from three 32-bit products.
+__attribute__((target("avx2")))
+static int drawPicksAVX2(uint64_t *rng, uint64_t *pick, int count, int emptyCount) {
+    const __m256i low = _mm256_set1_epi64x(0xFFFFFFFFLL);
+    const __m256i multLow = _mm256_set1_epi64x(0x4F6CDD1DLL);
+    const __m256i multHigh = _mm256_set1_epi64x(0x2545F491LL);
+    const __m256i range = _mm256_set1_epi64x(emptyCount);
+    int lane = 0;
+
+    for (; lane + 4 <= count; lane += 4) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(rng + lane));
+        s = _mm256_xor_si256(s, _mm256_srli_epi64(s, 12));
+        s = _mm256_xor_si256(s, _mm256_slli_epi64(s, 25));
+        s = _mm256_xor_si256(s, _mm256_srli_epi64(s, 27));
+        _mm256_storeu_si256((__m256i *)(rng + lane), s);
+
+        __m256i carry = _mm256_srli_epi64(_mm256_mul_epu32(s, multLow), 32);
+        __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(s, 32), multLow),
+                                         _mm256_mul_epu32(s, multHigh));
+        __m256i draw = _mm256_and_si256(_mm256_add_epi64(carry, cross), low);
+        _mm256_storeu_si256((__m256i *)(pick + lane), _mm256_srli_epi64(_mm256_mul_epu32(draw, range), 32));
+    }
+    return lane;
+}
+
+// Sets the rank-th empty cell of every unfinished lane in one instruction
+__attribute__((target("bmi2")))
+static void placePicksBMI2(RolloutBatch *batch, int side, uint64_t full) {
+    for (int lane = 0; lane < batch->count; lane++) {
+        if (batch->status[lane] != 0) continue;
+
+        uint64_t empty = ~(batch->bits[0][lane] | batch->bits[1][lane]) & full;
+        batch->bits[side][lane] |= _pdep_u64((uint64_t)1 << batch->pick[lane], empty);
+    }
+}
+#endif
+
+// Picks the widest kernels the running CPU supports; called once from
+// tictactoeInit. Compilers or CPUs without the dispatch keep plain C.
+static void initRolloutKernel() {
+#ifdef ROLLOUT_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        rolloutKernelId = ROLLOUT_AVX2;
+    } else if (__builtin_cpu_supports("sse4.1")) {
+        rolloutKernelId = ROLLOUT_SSE41;
+    }
+    rolloutHasPdep = __builtin_cpu_supports("bmi2");
+#endif
+}
+
+// Sets won[lane] to all ones where the side owns a complete line. The
+// vector kernel for this CPU takes as many lanes as it can and the scalar
+// loop covers the rest, or the whole batch on machines without AVX2/SSE4.1.
+static void markRolloutWins(RolloutBatch *batch, int side) {
+    const uint64_t *own = batch->bits[side];
+    uint64_t *won = batch->won;
+    int lane = 0;
+
+#ifdef ROLLOUT_DISPATCH
+    switch (rolloutKernelId) {
+        case ROLLOUT_AVX2:
+            lane = markWinsAVX2(own, won, batch->count, batch->winLines, batch->numLines);
+            break;
+        case ROLLOUT_SSE41:
+            lane = markWinsSSE41(own, won, batch->count, batch->winLines, batch->numLines);
+            break;
+    }
+#endif
+
+    for (; lane < batch->count; lane++) {
+        uint64_t hit = 0;
+        for (int i = 0; i < batch->numLines; i++) {
+            hit |= (uint64_t)0 - (uint64_t)((own[lane] & batch->winLines[i]) == batch->winLines[i]);
+        }
+        won[lane] = hit;
+    }
+}
+
+// Advances every lane's generator and draws the rank of the empty cell it
+// plays next. Finished lanes draw too; their picks are never used.
+static void drawRolloutPicks(RolloutBatch *batch) {
+    int emptyCount = batch->cells - batch->moves;
+    int lane = 0;
+
+#ifdef ROLLOUT_DISPATCH
+    if (rolloutKernelId == ROLLOUT_AVX2) {
+        lane = drawPicksAVX2(batch->rng, batch->pick, batch->count, emptyCount);
+    }
+#endif
+
+    for (; lane < batch->count; lane++) {
+        // xorshift64* per lane keeps the lanes independent of each other
+        uint64_t s = batch->rng[lane];
+        s ^= s >> 12;
+        s ^= s << 25;
+        s ^= s >> 27;
+        batch->rng[lane] = s;
+
+        // Multiply-shift instead of % so the vector kernel draws the same ranks
+        uint64_t draw = ((s * 0x2545F4914F6CDD1DULL) >> 32) & 0xFFFFFFFFULL;
+        batch->pick[lane] = (draw * (uint64_t)emptyCount) >> 32;
+    }
+}
+
+// Sets the picked empty cell in every unfinished lane
+static void placeRolloutPicks(RolloutBatch *batch, int side) {
+    uint64_t full = (batch->cells == 64) ? ~(uint64_t)0 : ((uint64_t)1 << batch->cells) - 1;
+
+#ifdef ROLLOUT_DISPATCH
+    if (rolloutHasPdep) {
+        placePicksBMI2(batch, side, full);
+        return;
+    }
+#endif
+
+    for (int lane = 0; lane < batch->count; lane++) {
+        if (batch->status[lane] != 0) continue;
+
+        // Drop the lowest empty cells until the chosen one is lowest
+        uint64_t empty = ~(batch->bits[0][lane] | batch->bits[1][lane]) & full;
+        for (uint64_t skip = batch->pick[lane]; skip > 0; skip--) empty &= empty - 1;
+        batch->bits[side][lane] |= empty & (~empty + 1);
+    }
+}
+
+// Plays one random move for the side in every unfinished lane. The draws and
+// the win check run across lanes in vector registers; finding the n-th set
+// bit of a lane has no AVX2 form, so placing uses BMI2 PDEP per lane.
+static void stepRolloutBatch(RolloutBatch *batch, int side) {
+    drawRolloutPicks(batch);
+    placeRolloutPicks(batch, side);
+    batch->moves++;
+
+    markRolloutWins(batch, side);
+    for (int lane = 0; lane < batch->count; lane++) {
+        if (batch->status[lane] != 0) continue;
+        if (batch->won[lane]) {
+            batch->status[lane] = (char)(side + 1);
+        } else if (batch->moves == batch->cells) {
+            batch->status[lane] = 3;
+        }
+    }
+}
+
+// Plays random games to the end from the position and tallies the results:
+// results[0] = draws, results[1] = X wins, results[2] = O wins (the winner
+// codes of playBotGame). Returns the number of games played.
+int runRollouts(Game *start, int games, uint64_t seed, int results[3]) {
+    RolloutBatch batch;
+    int played = 0;
+
+    tictactoeInit(); // Resolves the rollout kernels
+    results[0] = results[1] = results[2] = 0;
+
+    while (played < games) {
+        int count = (games - played < ROLLOUT_LANES) ? games - played : ROLLOUT_LANES;
+        int side = (sideToMove(start) == 'X') ? 0 : 1;
+
+        if (!initRolloutBatch(&batch, start, count, seed + (uint64_t)played)) break;
+
+        while (batch.moves < batch.cells) {
+            int ongoing = 0;
+            for (int lane = 0; lane < count; lane++) {
+                if (batch.status[lane] == 0) ongoing++;
+            }
+            if (ongoing == 0) break;
+
+            stepRolloutBatch(&batch, side);
+            side = 1 - side;
+        }
+
+        for (int lane = 0; lane < count; lane++) {
+            results[batch.status[lane] == 3 ? 0 : batch.status[lane]]++;
+        }
+        freeRolloutBatch(&batch);
+        played += count;
+    }
+
+    return played;
+}
+
+// Reports which win-check kernel this build uses
+const char *rolloutKernelName() {
+    tictactoeInit();
+    switch (rolloutKernelId) {
+        case ROLLOUT_AVX2:
+            return (rolloutHasPdep) ? "AVX2+BMI2" : "AVX2";
+        case ROLLOUT_SSE41:
+            return "SSE4.1";
+        default:
+            return "scalar";
+    }
+}
+
+// -------------------------
+// Learned Evaluation Functions
+// -------------------------
+// The model is linear in the incremental pattern counters, squashed by tanh
+// into a value for the side to move:
+//   f[0]           bias (the side to move's tempo)
+//   f[k]           lines open to the side to move holding k stones
+//   f[L - 1 + k]   lines open to the opponent holding k stones
+// so a leaf costs one pass over patternCount and a 16-float dot product.
+static int evalFeatures(Game *game, int side, float *features) {
+    int length = game->lineLength;
+
+    memset(features, 0, EVAL_FEATURES * sizeof(float));
+    features[0] = 1.0f;
+    for (int k = 1; k < length; k++) {
+        features[k] = game->patternCount[side][k] * EVAL_FEATURE_SCALE;
+        features[length - 1 + k] = game->patternCount[1 - side][k] * EVAL_FEATURE_SCALE;
+    }
+
+    return 2 * length - 1;
+}
+
+static float evalDot(const float *weights, const float *features) {
+#if defined(__AVX__)
+    __m256 sum = _mm256_mul_ps(_mm256_loadu_ps(weights), _mm256_loadu_ps(features));
+    sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(weights + 8), _mm256_loadu_ps(features + 8)));
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+#elif defined(__SSE__)
+    __m128 half = _mm_setzero_ps();
+    for (int i = 0; i < EVAL_FEATURES; i += 4) {
+        half = _mm_add_ps(half, _mm_mul_ps(_mm_loadu_ps(weights + i), _mm_loadu_ps(features + i)));
+    }
+#endif
+
+#if defined(__AVX__) || defined(__SSE__)
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+    return _mm_cvtss_f32(half);
+#else
+    float sum = 0.0f;
+    for (int i = 0; i < EVAL_FEATURES; i++) {
+        sum += weights[i] * features[i];
+    }
+    return sum;
+#endif
+}
+
+// Value of the position for the given side, assuming that side is to move
+static float evalValue(EvalModel *model, Game *game, int side) {
+    float features[EVAL_FEATURES];
+
+    evalFeatures(game, side, features);
+    return tanhf(evalDot(model->weights, features));
+}
+
+// Starting point before any training: the evaluateLines weights, shrunk
+// to the scale of the model
+static void defaultEvalModel(EvalModel *model, int boardSize) {
+    float open[5] = {0.0f, 0.02f, 0.16f, 1.28f, 10.24f};
+
+    memset(model, 0, sizeof(EvalModel));
+    model->boardSize = boardSize;
+
+    int length = (boardSize == GOMOKU_BOARD) ? GOMOKU_WIN : (boardSize == QUBIC_BOARD) ? 4 : boardSize;
+    for (int k = 1; k < length && k < 5; k++) {
+        model->weights[k] = open[k] / EVAL_FEATURE_SCALE / 10.0f;
+        model->weights[length - 1 + k] = -open[k] / EVAL_FEATURE_SCALE / 10.0f;
+    }
+}
+
+// Only the standard rules have a model; custom rules return NULL
+static EvalModel *evalModelFor(Game *game) {
+    int boardSize;
+
+    if (game->layers > 1) {
+        boardSize = QUBIC_BOARD;
+    } else if (game->size == GOMOKU_SIZE && game->lineLength == GOMOKU_WIN) {
+        boardSize = GOMOKU_BOARD;
+    } else if ((game->size == 3 || game->size == 4) && game->lineLength == game->size) {
+        boardSize = game->size;
+    } else {
+        return NULL;
+    }
+
+    return &evalModels[boardSize];
+}
+
+// Leaf evaluator with the evaluateLines signature: symbol has just moved,
+// so the model is asked about the opponent, who is to move
+static int learnedEvaluate(Game *game, char symbol) {
+    EvalModel *model = evalModelFor(game);
+    int side = (symbol == 'X') ? 0 : 1;
+
+    if (model == NULL) return evaluateLines(game, symbol);
+    return (int)(-evalValue(model, game, 1 - side) * EVAL_SCORE_SCALE);
+}
+
+// Weights file: "TTTW", a model count byte, then per model the board code
+// byte, the games it was trained on (uint32) and EVAL_FEATURES floats
+int tictactoeLoadWeights(const char *path) {
+    FILE *file;
+    char magic[4];
+    int count;
+
+    tictactoeInit();
+    file = fopen(path, "rb");
+    if (file == NULL) return 0;
+
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, "TTTW", 4) != 0 || (count = fgetc(file)) == EOF) {
+        fclose(file);
+        return 0;
+    }
+
+    int loaded = 0;
+    for (int m = 0; m < count; m++) {
+        EvalModel model;
+        int boardSize = fgetc(file);
+        uint32_t games;
+
+        if (boardSize == EOF || fread(&games, sizeof(games), 1, file) != 1 ||
+            fread(model.weights, sizeof(float), EVAL_FEATURES, file) != EVAL_FEATURES) break;
+        if (boardSize < 3 || boardSize > GOMOKU_BOARD) continue;
+
+        model.boardSize = boardSize;
+        model.gamesTrained = (int)games;
+        evalModels[boardSize] = model;
+        loaded++;
+    }
+
+    fclose(file);
+    return loaded;
+}
+
+int saveEvalWeights(const char *path) {
+    FILE *file = fopen(path, "wb");
+    int count = 0;
+
+    if (file == NULL) return 0;
+
+    for (int size = 3; size <= GOMOKU_BOARD; size++) {
+        if (evalModels[size].gamesTrained > 0) count++;
+    }
+
+    fwrite("TTTW", 1, 4, file);
+    fputc(count, file);
+    for (int size = 3; size <= GOMOKU_BOARD; size++) {
+        uint32_t games = (uint32_t)evalModels[size].gamesTrained;
+        if (games == 0) continue;
+
+        fputc(size, file);
+        fwrite(&games, sizeof(games), 1, file);
+        fwrite(evalModels[size].weights, sizeof(float), EVAL_FEATURES, file);
+    }
+
+    return fclose(file) == 0;
+}
+
+// Picks the move leaving the opponent the worst value; epsilon of the moves
+// are random so self-play keeps visiting new positions
+static int evalGreedyMove(EvalModel *model, Game *game, char symbol, float epsilon) {
+    int side = (symbol == 'X') ? 0 : 1;
+    int large = (game->cells > 64);
+    float best = 2.0f;
+    int bestMove = 0;
+
+    if (large && game->moves == 0) return (game->size / 2) * game->size + game->size / 2 + 1;
+    if (randomBelow(game, 1 << 24) < epsilon * (1 << 24)) return randomMove(game);
+
+    for (int cell = 0; cell < game->cells; cell++) {
+        if (!isValidMove(game, cell + 1)) continue;
+        if (large && !isNearStone(game, cell)) continue;
+
+        makeMove(game, cell + 1, symbol);
+        float value = lastMoveWins(game) ? -2.0f : isDraw(game) ? 0.0f : evalValue(model, game, 1 - side);
+        unmakeMove(game);
+
+        if (value < best) {
+            best = value;
+            bestMove = cell + 1;
+        }
+    }
+
+    return (bestMove != 0) ? bestMove : randomMove(game);
+}
+
+// TD(0) self-play: after every move the value of the position before it is
+// pulled toward the negated value of the position after it (or toward the
+// result when the move ended the game)
+void trainEvaluator(int boardSize, int games) {
+    EvalModel *model;
+    Game game;
+
+    tictactoeInit();
+    model = &evalModels[boardSize];
+    initializeBoard(&game, boardSize);
+    seedGame(&game, (uint64_t)model->gamesTrained); // Each training run explores new games
+
+    for (int g = 0; g < games; g++) {
+        char symbol = 'X';
+
+        // Step size decays slowly as the model settles
+        float rate = EVAL_LEARNING_RATE / (1.0f + model->gamesTrained / 2000.0f);
+
+        while (1) {
+            int side = (symbol == 'X') ? 0 : 1;
+            float features[EVAL_FEATURES];
+            float target;
+
+            evalFeatures(&game, side, features);
+            float value = tanhf(evalDot(model->weights, features));
+
+            makeMove(&game, evalGreedyMove(model, &game, symbol, EVAL_EXPLORATION), symbol);
+            int over = 1;
+            if (lastMoveWins(&game)) {
+                target = 1.0f;
+            } else if (isDraw(&game)) {
+                target = 0.0f;
+            } else {
+                target = -evalValue(model, &game, 1 - side);
+                over = 0;
+            }
+
+            float step = rate * (target - value) * (1.0f - value * value);
+            for (int i = 0; i < EVAL_FEATURES; i++) {
+                model->weights[i] += step * features[i];
+            }
+
+            if (over) break;
+            symbol = (symbol == 'X') ? 'O' : 'X';
+        }
+
+        model->gamesTrained++;
+        undoMoves(&game, game.historyTop);
+    }
+
+    freeBoard(&game);
+}
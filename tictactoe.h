@@ -0,0 +1,62 @@
+#ifndef TICTACTOE_H
+#define TICTACTOE_H
+
+// Public API of the tic-tac-toe engine: position analysis for 3x3, 4x4,
+// Qubic (4x4x4) and Gomoku (15x15) boards
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -------------------------
+// Structure Definitions
+// -------------------------
+typedef struct {
+    int boardSize; // Board size code (3, 4, QUBIC_BOARD, GOMOKU_BOARD), 0 = unreadable
+    int status;    // 0 = ongoing, 1 = win, 2 = draw
+    char toMove;   // Side to move in the position
+    int value;     // 1 = win, 0 = draw, -1 = loss for the side to move (when solved)
+    int solved;    // 1 if the value is exact, 0 if it is only a search estimate
+    int bestMove;  // 1-based cell of the best move found, 0 if none
+    int score;     // Search score behind bestMove, from the side to move
+    int depth;     // Search depth the position was analyzed to
+} PositionAnalysis;
+
+// -------------------------
+// Board Definitions
+// -------------------------
+#define QUBIC_BOARD       5   // Board size code used by the menus and history
+#define GOMOKU_BOARD      6   // Board size code used by the menus and history
+
+// -------------------------
+// Function Prototypes
+// -------------------------
+// Builds the shared tables (hash keys, default evaluation weights) and
+// picks the rollout kernels, without touching any file. Call once before
+// anything else; it is safe to call again or from any thread.
+void tictactoeInit();
+
+// Replaces the default evaluation weights with the trained ones in path
+// (written by the game's trainer). Returns the number of board models read,
+// 0 if the file is missing or unreadable. Call it before starting searches.
+int tictactoeLoadWeights(const char *path);
+
+// Positions are strings of 'X', 'O' and '.' (or '-') per cell; other
+// characters are skipped. 9, 16, 64 or 225 cells pick the board.
+int positionBoardSize(const char *text);
+
+// Search depth used when a caller passes depth 0
+int defaultAnalysisDepth(int boardSize);
+
+// depth 0 uses defaultAnalysisDepth for each position's board
+void analyzePosition(const char *text, int depth, PositionAnalysis *result);
+
+// Analyzes count positions on up to threads threads (0 = one per CPU).
+// Returns the number of positions that could be read.
+int analyzePositions(const char **positions, int count, int depth, int threads, PositionAnalysis *results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
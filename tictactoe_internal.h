@@ -0,0 +1,175 @@
+#ifndef TICTACTOE_INTERNAL_H
+#define TICTACTOE_INTERNAL_H
+
+// Engine internals shared by tictactoe.c and the game in Project.c; other
+// programs use the API in tictactoe.h
+
+#include <stdint.h>
+#include <time.h>
+
+#include "tictactoe.h"
+#include "ttt_thread.h"
+
+// -------------------------
+// Structure Definitions
+// -------------------------
+typedef struct {
+    int cell;          // 0-based cell index of the move
+    char symbol;       // Symbol placed on the cell
+    uint64_t prevHash; // Position hash before the move
+} UndoEntry;
+
+typedef struct {
+    char *board;   // Dynamic 1D array for NxN (or NxNxN) board
+    int size;      // Board dimension (3x3, 4x4 & 4x4x4)
+    int layers;    // 1 for flat boards, 4 for Qubic
+    int cells;     // Total number of cells
+    int moves;     // Number of moves made
+    int status;    // 0 = ongoing, 1 = win, 2 = draw
+    uint64_t bits[2]; // Occupancy bitboards for X and O (one bit per cell)
+    const uint64_t *winLines; // Winning line masks (NULL on boards over 64 cells)
+    int numLines;  // Number of winning lines
+    int (*hasLine)(uint64_t bits); // Win check specialized for this board size (NULL = generic)
+    uint64_t *ownedLines; // Line table generated for a custom rule, freed with the board
+    int lineLength;     // Stones needed on a line to win
+    int *lineCells;     // Cells of every line: [line * lineLength + k]
+    int *lineCount;     // Stones per line and side: [line * 2 + side]
+    int patternCount[2][8]; // Lines open to a side (no enemy stones) by stone count
+    int *cellLineStart; // Offset into cellLines for each cell (cells + 1 entries)
+    int *cellLines;     // Lines passing through each cell
+    uint64_t hash;      // Zobrist hash of the current position
+    uint64_t rng;       // Random state of the engines playing on this board (seedGame)
+    UndoEntry *history; // Move stack shared by search and user undo/redo
+    int historyTop;     // Moves currently applied
+    int historyEnd;     // Moves available for redo end here
+} Game;
+
+// Scores a position for the side that just moved (evaluateLines, learnedEvaluate)
+typedef int (*LeafEvaluator)(Game *game, char symbol);
+
+typedef struct {
+    char name[20];
+    int type;      // ENGINE_RANDOM, ENGINE_HEURISTIC, ENGINE_MINIMAX, ENGINE_THREAT, ENGINE_LEARNED
+    int depth;     // Search depth (unused by non-searching engines)
+} BotEngine;
+
+typedef struct {
+    int count;          // Games (lanes) in the batch
+    int cells;          // Cells per board
+    int moves;          // Stones on every board; the lanes move in lockstep
+    int numLines;
+    const uint64_t *winLines;
+    uint64_t *bits[2];  // X and O bitboards: bits[side][lane]
+    uint64_t *rng;      // Random state per lane
+    uint64_t *pick;     // Empty cell (by rank) each lane plays next
+    uint64_t *won;      // All ones where the last move completed a line
+    char *status;       // 0 = ongoing, 1 = X won, 2 = O won, 3 = draw
+} RolloutBatch;
+
+typedef struct {
+    int boardSize;      // Board size code the weights belong to
+    int gamesTrained;   // Self-play games behind the weights (0 = defaults)
+    float weights[16];  // One weight per feature (EVAL_FEATURES)
+} EvalModel;
+
+// -------------------------
+// Engine Definitions
+// -------------------------
+#define ENGINE_RANDOM     0
+#define ENGINE_HEURISTIC  1
+#define ENGINE_MINIMAX    2
+#define ENGINE_THREAT     3
+#define ENGINE_LEARNED    4
+#define MAX_ENGINES       8
+#define MAX_CELLS         225
+#define WIN_SCORE         100000
+#define ROLLOUT_LANES     1024 // Games advanced together by runRollouts
+#define ROLLOUT_SCALAR    0    // Win-check kernels picked at run time
+#define ROLLOUT_SSE41     1
+#define ROLLOUT_AVX2      2
+
+// -------------------------
+// Qubic (4x4x4) Definitions
+// -------------------------
+#define QUBIC_LINES       76
+
+// -------------------------
+// Gomoku (15x15) Definitions
+// -------------------------
+#define GOMOKU_SIZE       15
+#define GOMOKU_WIN        5
+#define THREAT_BUDGET_MS  100 // Time the threat engine may spend per move
+#define GOMOKU_MAX_DEPTH  2   // Deepest minimax search on the 15x15 board
+
+// -------------------------
+// Learned Evaluation Definitions
+// -------------------------
+#define EVAL_FEATURES       16       // Feature vector width, padded for the vector dot product
+#define EVAL_FEATURE_SCALE  0.1f     // Pattern counts are scaled into a small range
+#define EVAL_SCORE_SCALE    10000.0f // Model values in (-1, 1) become search scores
+#define EVAL_LEARNING_RATE  0.02f
+#define EVAL_EXPLORATION    0.1f     // Share of random moves during self-play
+#define EVAL_WEIGHTS_FILE   "eval_weights.bin"
+
+// -------------------------
+// Position Analysis Definitions
+// -------------------------
+#define ANALYZE_CLAIM       16  // Positions a worker takes from the batch at a time
+#define ANALYZE_MAX_THREADS 64
+
+typedef struct {
+    const char **positions;
+    PositionAnalysis *results;
+    int count;
+    int depth;      // 0 = defaultAnalysisDepth per board
+    int next;       // First position nobody has claimed yet
+    int analyzed;
+    Mutex lock;     // Guards next and analyzed
+} AnalyzeBatch;
+
+// -------------------------
+// Global Variables
+// -------------------------
+extern BotEngine ttt_botEngines[MAX_ENGINES];
+extern int ttt_numBotEngines;
+
+// -------------------------
+// Function Prototypes
+// -------------------------
+// Only what the game needs is exported; the rest of the engine is static
+// in tictactoe.c
+void initializeBoard(Game *game, int size);
+void initializeBoardRule(Game *game, int size, int winLength);
+void seedGame(Game *game, uint64_t seed);
+int checkWinner(Game *game, char symbol);
+int checkWinnerScan(Game *game, char symbol);
+int isDraw(Game *game);
+void freeBoard(Game *game);
+int isValidMove(Game *game, int move);
+const char *boardSizeName(int boardSize);
+
+// Make/Unmake Functions
+void makeMove(Game *game, int move, char symbol);
+void unmakeMove(Game *game);
+int undoMoves(Game *game, int count);
+int redoMoves(Game *game, int count);
+int lastMoveWins(Game *game);
+
+// Bot Engine Functions
+int randomMove(Game *game);
+int chooseEngineMove(Game *game, char symbol, BotEngine *engine);
+BotEngine *findEngine(int type);
+
+// Threat-Space Search Functions
+int patternScore(Game *game, int side);
+int isNearStone(Game *game, int cell);
+
+// Batch Rollout Functions
+int runRollouts(Game *start, int games, uint64_t seed, int results[3]);
+const char *rolloutKernelName();
+
+// Learned Evaluation Functions
+int saveEvalWeights(const char *path);
+void trainEvaluator(int boardSize, int games);
+
+#endif
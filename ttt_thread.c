@@ -0,0 +1,141 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "ttt_thread.h"
+
+// -------------------------
+// Thread Functions
+// -------------------------
+#ifdef _WIN32
+typedef struct {
+    void *(*run)(void *arg);
+    void *arg;
+} ThreadStart;
+
+// CreateThread wants a DWORD WINAPI entry point, so the POSIX-style one
+// travels through a small heap block
+static DWORD WINAPI threadTrampoline(LPVOID param) {
+    ThreadStart start = *(ThreadStart *)param;
+
+    free(param);
+    start.run(start.arg);
+    return 0;
+}
+
+int ttt_threadStart(Thread *thread, void *(*run)(void *arg), void *arg) {
+    ThreadStart *start = (ThreadStart *)malloc(sizeof(ThreadStart));
+
+    if (start == NULL) return 0;
+    start->run = run;
+    start->arg = arg;
+
+    *thread = CreateThread(NULL, 0, threadTrampoline, start, 0, NULL);
+    if (*thread == NULL) {
+        free(start);
+        return 0;
+    }
+    return 1;
+}
+
+void ttt_threadJoin(Thread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+void ttt_mutexInit(Mutex *mutex) { InitializeCriticalSection(mutex); }
+void ttt_mutexLock(Mutex *mutex) { EnterCriticalSection(mutex); }
+void ttt_mutexUnlock(Mutex *mutex) { LeaveCriticalSection(mutex); }
+void ttt_mutexDestroy(Mutex *mutex) { DeleteCriticalSection(mutex); }
+
+void ttt_conditionInit(Condition *condition) { InitializeConditionVariable(condition); }
+void ttt_conditionWait(Condition *condition, Mutex *mutex) { SleepConditionVariableCS(condition, mutex, INFINITE); }
+void ttt_conditionSignal(Condition *condition) { WakeConditionVariable(condition); }
+void ttt_conditionBroadcast(Condition *condition) { WakeAllConditionVariable(condition); }
+void ttt_conditionDestroy(Condition *condition) { (void)condition; }
+
+int ttt_cpuCount() {
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors > 0) ? (int)info.dwNumberOfProcessors : 1;
+}
+
+double ttt_wallSeconds() {
+    LARGE_INTEGER now, frequency;
+
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+    return (double)now.QuadPart / (double)frequency.QuadPart;
+}
+
+// Aligned 64-bit reads are atomic on Windows targets
+uint64_t ttt_atomicLoad64(volatile uint64_t *target) {
+    return *target;
+}
+
+// The interlocked functions are full barriers, which covers both orders
+void ttt_atomicStoreRelease64(volatile uint64_t *target, uint64_t value) {
+    InterlockedExchange64((volatile LONG64 *)target, (LONG64)value);
+}
+
+uint64_t ttt_atomicLoadAcquire64(volatile uint64_t *target) {
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64 *)target, 0, 0);
+}
+
+int ttt_atomicCompareSwap64(volatile uint64_t *target, uint64_t expected, uint64_t desired) {
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64 *)target, (LONG64)desired, (LONG64)expected) == expected;
+}
+#else
+int ttt_threadStart(Thread *thread, void *(*run)(void *arg), void *arg) {
+    return pthread_create(thread, NULL, run, arg) == 0;
+}
+
+void ttt_threadJoin(Thread thread) { pthread_join(thread, NULL); }
+
+void ttt_mutexInit(Mutex *mutex) { pthread_mutex_init(mutex, NULL); }
+void ttt_mutexLock(Mutex *mutex) { pthread_mutex_lock(mutex); }
+void ttt_mutexUnlock(Mutex *mutex) { pthread_mutex_unlock(mutex); }
+void ttt_mutexDestroy(Mutex *mutex) { pthread_mutex_destroy(mutex); }
+
+void ttt_conditionInit(Condition *condition) { pthread_cond_init(condition, NULL); }
+void ttt_conditionWait(Condition *condition, Mutex *mutex) { pthread_cond_wait(condition, mutex); }
+void ttt_conditionSignal(Condition *condition) { pthread_cond_signal(condition); }
+void ttt_conditionBroadcast(Condition *condition) { pthread_cond_broadcast(condition); }
+void ttt_conditionDestroy(Condition *condition) { pthread_cond_destroy(condition); }
+
+int ttt_cpuCount() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (int)count : 1;
+}
+
+double ttt_wallSeconds() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+uint64_t ttt_atomicLoad64(volatile uint64_t *target) {
+    return __atomic_load_n(target, __ATOMIC_RELAXED);
+}
+
+void ttt_atomicStoreRelease64(volatile uint64_t *target, uint64_t value) {
+    __atomic_store_n(target, value, __ATOMIC_RELEASE);
+}
+
+uint64_t ttt_atomicLoadAcquire64(volatile uint64_t *target) {
+    return __atomic_load_n(target, __ATOMIC_ACQUIRE);
+}
+
+int ttt_atomicCompareSwap64(volatile uint64_t *target, uint64_t expected, uint64_t desired) {
+    return __atomic_compare_exchange_n(target, &expected, desired, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+#endif
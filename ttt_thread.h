@@ -0,0 +1,71 @@
+#ifndef TTT_THREAD_H
+#define TTT_THREAD_H
+
+// Thin layer over Win32 and POSIX threads, shared by the engine, the game
+// and the lab programs. Every function carries the ttt_ prefix so the
+// layer can be linked into programs that have helpers of their own.
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -------------------------
+// Thread Definitions
+// -------------------------
+#ifdef _WIN32
+typedef HANDLE Thread;
+typedef CRITICAL_SECTION Mutex;
+typedef CONDITION_VARIABLE Condition;
+#else
+typedef pthread_t Thread;
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Condition;
+#endif
+
+// -------------------------
+// Function Prototypes
+// -------------------------
+// Returns 1 if the thread started
+int ttt_threadStart(Thread *thread, void *(*run)(void *arg), void *arg);
+void ttt_threadJoin(Thread thread);
+
+void ttt_mutexInit(Mutex *mutex);
+void ttt_mutexLock(Mutex *mutex);
+void ttt_mutexUnlock(Mutex *mutex);
+void ttt_mutexDestroy(Mutex *mutex);
+
+void ttt_conditionInit(Condition *condition);
+void ttt_conditionWait(Condition *condition, Mutex *mutex);
+void ttt_conditionSignal(Condition *condition);
+void ttt_conditionBroadcast(Condition *condition);
+void ttt_conditionDestroy(Condition *condition);
+
+// Processors online, at least 1
+int ttt_cpuCount();
+
+// Monotonic wall time in seconds; clock() adds up every thread's CPU time
+double ttt_wallSeconds();
+
+uint64_t ttt_atomicLoad64(volatile uint64_t *target);
+
+// Release/acquire pair: whatever a thread wrote before the store is
+// visible to a thread that loads the stored value
+void ttt_atomicStoreRelease64(volatile uint64_t *target, uint64_t value);
+uint64_t ttt_atomicLoadAcquire64(volatile uint64_t *target);
+
+// Stores desired if the target still holds expected; returns 1 if it did
+int ttt_atomicCompareSwap64(volatile uint64_t *target, uint64_t expected, uint64_t desired);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif